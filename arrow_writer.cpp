@@ -0,0 +1,305 @@
+#include "arrow_writer.h"
+#include "common.h"
+
+#include <cstring>
+
+// minimal flatbuffer builder, enough for the Arrow metadata
+//
+// like with the flatbuffers library the buffer is built back to front, so
+// everything a table refers to is complete before the table itself; objects
+// are identified by their distance from the end of the buffer. The bytes
+// are kept in reverse order, so prepending is an append
+class FlatBuilder {
+public:
+    uint32_t size() const { return rev_.size(); }
+
+    template <class T>
+    void prepend(T v)
+    {
+        align(sizeof(T));
+        prepend_bytes(&v, sizeof(T));
+    }
+    uint32_t string(const std::string & s)
+    {
+        align(4, s.size() + 1);
+        prepend_bytes("", 1);
+        prepend_bytes(s.data(), s.size());
+        prepend<uint32_t>(s.size());
+        return size();
+    }
+    // vector of n structs of elem_size bytes each, laid out in data
+    uint32_t struct_vector(const void * data, size_t elem_size, size_t n, size_t elem_align)
+    {
+        align(std::max<size_t>(elem_align, 4), elem_size * n);
+        prepend_bytes(data, elem_size * n);
+        prepend<uint32_t>(n);
+        return size();
+    }
+    uint32_t offset_vector(const std::vector<uint32_t> & targets)
+    {
+        align(4, 4 * targets.size());
+        for (size_t i = targets.size(); i-- > 0;) prepend_offset(targets[i]);
+        prepend<uint32_t>(targets.size());
+        return size();
+    }
+
+    void start_table()
+    {
+        fields_.clear();
+        table_start_ = size();
+    }
+    template <class T>
+    void add(int field, T v)
+    {
+        prepend(v);
+        fields_.push_back({ field, size() });
+    }
+    void add_offset(int field, uint32_t target)
+    {
+        prepend_offset(target);
+        fields_.push_back({ field, size() });
+    }
+    // the vtable goes right before the table, which points back to it
+    uint32_t end_table()
+    {
+        prepend<int32_t>(0);
+        uint32_t table = size();
+        int nfields = 0;
+        for (auto & f : fields_) nfields = std::max(nfields, f.first + 1);
+        std::vector<uint16_t> vt(2 + nfields, 0);
+        vt[0] = vt.size() * 2;
+        vt[1] = table - table_start_;
+        for (auto & f : fields_) vt[2 + f.first] = table - f.second;
+        for (size_t i = vt.size(); i-- > 0;) prepend(vt[i]);
+        int32_t soffset = size() - table;
+        patch(table, &soffset, 4);
+        return table;
+    }
+
+    // the finished buffer, with the root table offset in front and a size
+    // that is a multiple of 8
+    std::string finish(uint32_t root)
+    {
+        align(8, 4);
+        prepend_offset(root);
+        return std::string(rev_.rbegin(), rev_.rend());
+    }
+
+private:
+    std::vector<char> rev_;
+    std::vector<std::pair<int, uint32_t>> fields_;
+    uint32_t table_start_ = 0;
+
+    void prepend_bytes(const void * data, size_t len)
+    {
+        const char * p = static_cast<const char *>(data);
+        for (size_t i = len; i-- > 0;) rev_.push_back(p[i]);
+    }
+    // pads so that an object of len bytes prepended next starts aligned to a
+    // (the final buffer starts 8-aligned and has a size multiple of 8)
+    void align(size_t a, size_t len = 0)
+    {
+        while ((size() + len) % a != 0) rev_.push_back(0);
+    }
+    void prepend_offset(uint32_t target)
+    {
+        align(4);
+        prepend<uint32_t>(size() + 4 - target);
+    }
+    void patch(uint32_t pos, const void * data, size_t len)
+    {
+        const char * p = static_cast<const char *>(data);
+        for (size_t i = 0; i < len; i++) rev_[pos - 1 - i] = p[i];
+    }
+};
+
+// Arrow metadata, see format/Schema.fbs, Message.fbs and File.fbs
+namespace arrow_fb {
+// MetadataVersion::V5
+constexpr int16_t kVersion = 4;
+// MessageHeader union
+constexpr uint8_t kSchema = 1, kRecordBatch = 3;
+// Type union
+constexpr uint8_t kInt = 2;
+
+struct FieldNode {
+    int64_t length, null_count;
+};
+struct Buffer {
+    int64_t offset, length;
+};
+struct Block {
+    int64_t offset;
+    int32_t meta_len, pad;
+    int64_t body_len;
+};
+static_assert(sizeof(FieldNode) == 16 && sizeof(Buffer) == 16 && sizeof(Block) == 24,
+    "the structs are laid out as in the flatbuffer schema");
+}
+
+struct Column {
+    const char * name;
+    int bits;
+};
+static const Column kColumns[] = { { "id", 32 }, { "arrival", 64 }, { "burst", 64 },
+    { "start", 64 }, { "finish", 64 }, { "turnaround", 64 }, { "waiting", 64 },
+    { "response", 64 } };
+static constexpr int kNumColumns = sizeof(kColumns) / sizeof(kColumns[0]);
+
+static uint32_t build_schema(FlatBuilder & fb)
+{
+    std::vector<uint32_t> fields;
+    for (const Column & c : kColumns) {
+        uint32_t name = fb.string(c.name);
+        uint32_t children = fb.offset_vector({});
+        fb.start_table();
+        fb.add<int32_t>(0, c.bits);
+        fb.add<uint8_t>(1, 1);
+        uint32_t type = fb.end_table();
+        fb.start_table();
+        fb.add_offset(0, name);
+        fb.add<uint8_t>(1, 0);
+        fb.add<uint8_t>(2, arrow_fb::kInt);
+        fb.add_offset(3, type);
+        fb.add_offset(5, children);
+        fields.push_back(fb.end_table());
+    }
+    uint32_t vec = fb.offset_vector(fields);
+    fb.start_table();
+    fb.add<int16_t>(0, 0);
+    fb.add_offset(1, vec);
+    return fb.end_table();
+}
+
+static std::string build_message(
+    FlatBuilder & fb, uint8_t header_type, uint32_t header, int64_t body_len)
+{
+    fb.start_table();
+    fb.add<int64_t>(3, body_len);
+    fb.add_offset(2, header);
+    fb.add<int16_t>(0, arrow_fb::kVersion);
+    fb.add<uint8_t>(1, header_type);
+    return fb.finish(fb.end_table());
+}
+
+// body buffers are padded to 64 bytes, as recommended for SIMD access
+static int64_t padded(int64_t len) { return (len + 63) & ~int64_t(63); }
+
+ArrowResultWriter::ArrowResultWriter(const std::string & path, int64_t batch_rows)
+    : path_(path), batch_rows_(std::max<int64_t>(1, batch_rows))
+{
+    f_ = fopen(path.c_str(), "wb");
+    if (!f_) throw fatal_error() << "cannot open Arrow file " << path;
+    buf_.resize(1 << 20);
+    setvbuf(f_, buf_.data(), _IOFBF, buf_.size());
+    write("ARROW1\0\0", 8);
+    FlatBuilder fb;
+    uint32_t schema = build_schema(fb);
+    write_message(build_message(fb, arrow_fb::kSchema, schema, 0), 0);
+}
+
+ArrowResultWriter::~ArrowResultWriter()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void ArrowResultWriter::write(const void * data, size_t len)
+{
+    fwrite(data, 1, len, f_);
+    offset_ += len;
+}
+
+void ArrowResultWriter::pad(int64_t len)
+{
+    static const char zeros[64] = {};
+    write(zeros, len);
+}
+
+// writes the encapsulated message header: continuation marker, metadata
+// length and metadata; the caller writes the body_len bytes of the body
+ArrowResultWriter::Block ArrowResultWriter::write_message(const std::string & meta, int64_t body_len)
+{
+    Block b { offset_, int32_t(8 + meta.size()), body_len };
+    int32_t prefix[2] = { -1, int32_t(meta.size()) };
+    write(prefix, 8);
+    write(meta.data(), meta.size());
+    return b;
+}
+
+void ArrowResultWriter::add(const Process & p)
+{
+    bool started = p.start_time >= 0, finished = p.finish_time >= 0;
+    int64_t turnaround = finished ? p.finish_time - p.arrival_time : -1;
+    ids_.push_back(p.id);
+    int64_t row[7] = { p.arrival_time, p.burst, p.start_time, p.finish_time, turnaround,
+        finished ? turnaround - p.burst : -1, started ? p.start_time - p.arrival_time : -1 };
+    for (int c = 0; c < 7; c++) cols_[c].push_back(row[c]);
+    rows_++;
+    if ((int64_t)ids_.size() >= batch_rows_) flush_batch();
+}
+
+void ArrowResultWriter::flush_batch()
+{
+    int64_t n = ids_.size();
+    if (n == 0) return;
+    // each column has an empty validity buffer (no nulls) and a data buffer
+    std::vector<arrow_fb::FieldNode> nodes(kNumColumns, { n, 0 });
+    std::vector<arrow_fb::Buffer> buffers;
+    int64_t body_len = 0;
+    for (const Column & c : kColumns) {
+        int64_t len = n * c.bits / 8;
+        buffers.push_back({ body_len, 0 });
+        buffers.push_back({ body_len, len });
+        body_len += padded(len);
+    }
+    FlatBuilder fb;
+    uint32_t buffer_vec = fb.struct_vector(buffers.data(), sizeof(arrow_fb::Buffer), buffers.size(), 8);
+    uint32_t node_vec = fb.struct_vector(nodes.data(), sizeof(arrow_fb::FieldNode), nodes.size(), 8);
+    fb.start_table();
+    fb.add<int64_t>(0, n);
+    fb.add_offset(1, node_vec);
+    fb.add_offset(2, buffer_vec);
+    uint32_t batch = fb.end_table();
+    blocks_.push_back(write_message(build_message(fb, arrow_fb::kRecordBatch, batch, body_len), body_len));
+
+    write(ids_.data(), n * 4);
+    pad(padded(n * 4) - n * 4);
+    for (auto & col : cols_) {
+        write(col.data(), n * 8);
+        pad(padded(n * 8) - n * 8);
+        col.clear();
+    }
+    ids_.clear();
+}
+
+void ArrowResultWriter::close()
+{
+    if (!f_) return;
+    flush_batch();
+    // end-of-stream marker, then the footer indexing the schema and batches
+    int32_t eos[2] = { -1, 0 };
+    write(eos, 8);
+    FlatBuilder fb;
+    std::vector<arrow_fb::Block> blocks;
+    for (auto & b : blocks_) blocks.push_back({ b.offset, b.meta_len, 0, b.body_len });
+    uint32_t batch_vec = fb.struct_vector(blocks.data(), sizeof(arrow_fb::Block), blocks.size(), 8);
+    uint32_t dict_vec = fb.struct_vector(nullptr, sizeof(arrow_fb::Block), 0, 8);
+    uint32_t schema = build_schema(fb);
+    fb.start_table();
+    fb.add_offset(1, schema);
+    fb.add_offset(2, dict_vec);
+    fb.add_offset(3, batch_vec);
+    fb.add<int16_t>(0, arrow_fb::kVersion);
+    std::string footer = fb.finish(fb.end_table());
+    write(footer.data(), footer.size());
+    int32_t footer_len = footer.size();
+    write(&footer_len, 4);
+    write("ARROW1", 6);
+    bool ok = !ferror(f_);
+    ok = fclose(f_) == 0 && ok;
+    f_ = nullptr;
+    if (!ok) throw fatal_error() << "error writing Arrow file " << path_;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "scheduler.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// writes simulation results as an Arrow IPC file (the random-access
+/// format, also known as Feather v2), which Arrow readers can memory-map
+/// and use without conversion, e.g. pyarrow.ipc.open_file(pa.memory_map(path))
+///
+/// columns, none of them nullable (-1 marks a process that did not start or
+/// finish, like in the text table):
+///   id int32, arrival, burst, start, finish int64,
+///   turnaround (finish - arrival), waiting (turnaround - burst) and
+///   response (start - arrival) int64
+///
+/// rows are buffered per column and written as one record batch every
+/// batch_rows rows, so a writer fed while the simulation runs (see
+/// OnlineRR::on_finish) writes the file as it goes and holds only one batch
+/// in memory. The flatbuffer metadata is encoded in-tree, there is no
+/// dependency on the Arrow libraries
+///
+/// example:
+///   ArrowResultWriter out("results.arrow");
+///   for (auto & p : procs) out.add(p);
+///   out.close();
+class ArrowResultWriter {
+public:
+    /// creates path and writes the schema; throws fatal_error on failure
+    explicit ArrowResultWriter(const std::string & path, int64_t batch_rows = 1 << 16);
+    /// closes the file if close() has not been called, ignoring errors
+    ~ArrowResultWriter();
+    ArrowResultWriter(const ArrowResultWriter &) = delete;
+    ArrowResultWriter & operator=(const ArrowResultWriter &) = delete;
+
+    /// appends the row of p
+    void add(const Process & p);
+    /// writes the last batch and the footer; throws fatal_error if writing
+    /// failed
+    void close();
+    /// rows and record batches written so far
+    int64_t rows() const { return rows_; }
+    int64_t batches() const { return blocks_.size(); }
+
+private:
+    // where a message is in the file, for the footer
+    struct Block {
+        int64_t offset;
+        int32_t meta_len;
+        int64_t body_len;
+    };
+    FILE * f_ = nullptr;
+    std::string path_;
+    std::vector<char> buf_;
+    int64_t batch_rows_;
+    int64_t offset_ = 0, rows_ = 0;
+    // columns of the batch being filled
+    std::vector<int32_t> ids_;
+    std::vector<int64_t> cols_[7];
+    std::vector<Block> blocks_;
+
+    void write(const void * data, size_t len);
+    void pad(int64_t len);
+    Block write_message(const std::string & meta, int64_t body_len);
+    void flush_batch();
+};
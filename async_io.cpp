@@ -0,0 +1,313 @@
+#include "async_io.h"
+#include "common.h"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// io_uring instance set up with the raw syscalls, so there is no
+// dependency on liburing; only what BlockReader/BlockWriter need
+class IoUring {
+public:
+    explicit IoUring(unsigned entries)
+    {
+        io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        fd_ = syscall(__NR_io_uring_setup, entries, &p);
+        if (fd_ < 0) return;
+        // reads and writes at offset -1 use the file position, as for a pipe
+        if (!(p.features & IORING_FEAT_RW_CUR_POS)) {
+            close_fd();
+            return;
+        }
+        sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        sq_ = map(sq_size_, IORING_OFF_SQ_RING);
+        cq_ = p.features & IORING_FEAT_SINGLE_MMAP ? sq_ : map(cq_size_, IORING_OFF_CQ_RING);
+        sqes_ = static_cast<io_uring_sqe *>(
+            map(p.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES));
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        if (!sq_ || !cq_ || !sqes_) {
+            close_fd();
+            return;
+        }
+        char * sq = static_cast<char *>(sq_);
+        char * cq = static_cast<char *>(cq_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        sq_entries_ = p.sq_entries;
+        cq_head_ = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+    }
+    ~IoUring() { close_fd(); }
+
+    bool ok() const { return fd_ >= 0; }
+
+    // queues a read or write of len bytes at offset (-1 = file position);
+    // returns false if the submission queue is full
+    bool prep(uint8_t opcode, int fd, const void * buf, unsigned len, int64_t offset, uint64_t tag)
+    {
+        unsigned tail = *sq_tail_;
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) return false;
+        unsigned i = tail & sq_mask_;
+        io_uring_sqe & sqe = sqes_[i];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(buf);
+        sqe.len = len;
+        sqe.off = offset;
+        sqe.user_data = tag;
+        sq_array_[i] = i;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        unsubmitted_++;
+        return true;
+    }
+    // submits the queued requests and waits until at least wait_nr have
+    // completed; returns false (with errno set) on failure
+    bool enter(unsigned wait_nr)
+    {
+        while (true) {
+            int r = syscall(__NR_io_uring_enter, fd_, unsubmitted_, wait_nr,
+                wait_nr ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (r >= 0) {
+                unsubmitted_ -= std::min<unsigned>(r, unsubmitted_);
+                return true;
+            }
+            if (errno != EINTR) return false;
+        }
+    }
+    // takes the oldest completion, if any
+    bool pop(uint64_t & tag, int & res)
+    {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;
+        const io_uring_cqe & cqe = cqes_[head & cq_mask_];
+        tag = cqe.user_data;
+        res = cqe.res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    int fd_ = -1;
+    void * sq_ = nullptr, * cq_ = nullptr;
+    size_t sq_size_ = 0, cq_size_ = 0, sqes_size_ = 0;
+    io_uring_sqe * sqes_ = nullptr;
+    io_uring_cqe * cqes_ = nullptr;
+    unsigned * sq_head_ = nullptr, * sq_tail_ = nullptr, * sq_array_ = nullptr;
+    unsigned * cq_head_ = nullptr, * cq_tail_ = nullptr;
+    unsigned sq_mask_ = 0, cq_mask_ = 0, sq_entries_ = 0, unsubmitted_ = 0;
+
+    void * map(size_t size, off_t offset)
+    {
+        void * p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+    void close_fd()
+    {
+        if (sqes_) munmap(sqes_, sqes_size_);
+        if (cq_ && cq_ != sq_) munmap(cq_, cq_size_);
+        if (sq_) munmap(sq_, sq_size_);
+        sq_ = cq_ = nullptr;
+        sqes_ = nullptr;
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+    }
+};
+
+// a ring, or nullptr if io_uring cannot be used here
+static std::unique_ptr<IoUring> open_ring(unsigned entries, bool wanted)
+{
+    if (!wanted) return nullptr;
+    std::unique_ptr<IoUring> ring(new IoUring(entries));
+    if (!ring->ok()) ring.reset();
+    return ring;
+}
+
+BlockReader::BlockReader(int fd, size_t block_size, unsigned depth, bool use_io_uring)
+    : fd_(fd), block_size_(block_size)
+{
+    // several reads in flight need explicit offsets, so only regular files
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return;
+    next_offset_ = lseek(fd, 0, SEEK_CUR);
+    if (next_offset_ < 0) return;
+    ring_ = open_ring(std::max(depth, 1u), use_io_uring);
+    if (!ring_) return;
+    slots_.resize(std::max(depth, 1u));
+    for (size_t i = 0; i < slots_.size(); i++) issue(i);
+}
+
+BlockReader::~BlockReader()
+{
+    // the kernel may still be writing into the buffers
+    if (!ring_) return;
+    for (auto & s : slots_) {
+        while (s.in_flight) {
+            try {
+                reap();
+            } catch (...) {
+            }
+        }
+    }
+}
+
+// starts reading the next block into slot i
+void BlockReader::issue(size_t i)
+{
+    Slot & s = slots_[i];
+    s.buf.resize(block_size_);
+    s.offset = next_offset_;
+    s.got = 0;
+    s.done = false;
+    s.in_flight = true;
+    next_offset_ += block_size_;
+    ring_->prep(IORING_OP_READ, fd_, s.buf.data(), block_size_, s.offset, i);
+}
+
+// waits for at least one completion and handles all available ones; a
+// short read is continued where it stopped, so blocks come out whole
+void BlockReader::reap()
+{
+    if (!ring_->enter(1)) throw fatal_error() << "io_uring_enter: " << strerror(errno);
+    uint64_t i;
+    int res;
+    while (ring_->pop(i, res)) {
+        Slot & s = slots_[i];
+        s.in_flight = false;
+        if (res == -EINTR || res == -EAGAIN) {
+            res = 0;
+        } else if (res < 0) {
+            s.done = true;
+            throw fatal_error() << "read: " << strerror(-res);
+        } else if (res == 0 || s.got + res == block_size_) {
+            s.got += res;
+            s.done = true;
+            continue;
+        }
+        s.got += res;
+        s.in_flight = true;
+        ring_->prep(IORING_OP_READ, fd_, s.buf.data() + s.got, block_size_ - s.got, s.offset + s.got, i);
+    }
+}
+
+bool BlockReader::next(std::string & block)
+{
+    if (eof_) return false;
+    if (!ring_) {
+        block.resize(block_size_);
+        while (true) {
+            ssize_t r = read(fd_, block.data(), block_size_);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) throw fatal_error() << "read: " << strerror(errno);
+            block.resize(r);
+            eof_ = r == 0;
+            return r > 0;
+        }
+    }
+    Slot & s = slots_[front_];
+    while (!s.done) reap();
+    // a short block is the end of the file; later reads are past it
+    eof_ = s.got < block_size_;
+    if (s.got == 0) return false;
+    block = std::move(s.buf);
+    block.resize(s.got);
+    if (!eof_) issue(front_);
+    front_ = (front_ + 1) % slots_.size();
+    return true;
+}
+
+BlockWriter::BlockWriter(int fd, size_t block_size, bool use_io_uring)
+    : fd_(fd), ring_(open_ring(2, use_io_uring))
+{
+    for (auto & b : bufs_) b.resize(block_size);
+    setp(bufs_[0].data(), bufs_[0].data() + block_size);
+}
+
+BlockWriter::~BlockWriter() { sync(); }
+
+// hands the filled part of the current buffer over to the kernel and
+// switches to the other buffer, once its previous write has finished
+void BlockWriter::submit()
+{
+    size_t len = pptr() - pbase();
+    wait();
+    if (len > 0 && error_.empty()) {
+        pending_ = pbase();
+        pending_len_ = len;
+        if (ring_) {
+            ring_->prep(IORING_OP_WRITE, fd_, pending_, pending_len_, -1, 0);
+            if (!ring_->enter(0)) {
+                error_ = strerror(errno);
+                pending_len_ = 0;
+            }
+        } else {
+            wait();
+        }
+    }
+    cur_ ^= 1;
+    setp(bufs_[cur_].data(), bufs_[cur_].data() + bufs_[cur_].size());
+}
+
+// finishes the write in flight; short writes are continued
+void BlockWriter::wait()
+{
+    while (pending_len_ > 0) {
+        ssize_t r;
+        if (ring_) {
+            uint64_t tag;
+            int res;
+            if (!ring_->enter(1)) {
+                error_ = strerror(errno);
+                break;
+            }
+            if (!ring_->pop(tag, res)) continue;
+            r = res < 0 ? (errno = -res, -1) : res;
+        } else {
+            r = write(fd_, pending_, pending_len_);
+        }
+        if (r < 0 && (errno == EINTR || errno == EAGAIN)) {
+            r = 0;
+        } else if (r <= 0) {
+            error_ = r < 0 ? strerror(errno) : "nothing written";
+            break;
+        }
+        pending_ += r;
+        pending_len_ -= r;
+        if (ring_ && pending_len_ > 0) ring_->prep(IORING_OP_WRITE, fd_, pending_, pending_len_, -1, 0);
+    }
+    pending_len_ = 0;
+}
+
+BlockWriter::int_type BlockWriter::overflow(int_type c)
+{
+    submit();
+    if (!error_.empty()) return traits_type::eof();
+    if (c != traits_type::eof()) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int BlockWriter::sync()
+{
+    submit();
+    wait();
+    return error_.empty() ? 0 : -1;
+}
+
+void BlockWriter::finish()
+{
+    if (sync() != 0) throw fatal_error() << "write: " << error_;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+class IoUring;
+
+/// reads a file sequentially in big blocks
+///
+/// if fd is a regular file and io_uring is available, up to depth reads of
+/// the following blocks are kept in flight, so the next blocks are already
+/// being read while the caller works on the current one; otherwise (pipes,
+/// terminals, kernels or sandboxes without io_uring) it falls back to
+/// blocking read() calls. Reading starts at the current position of fd
+///
+/// example:
+///   BlockReader in(0, 1 << 20, 4);
+///   std::string block;
+///   while (in.next(block)) parse(block);
+class BlockReader {
+public:
+    BlockReader(int fd, size_t block_size, unsigned depth, bool use_io_uring = true);
+    ~BlockReader();
+    BlockReader(const BlockReader &) = delete;
+    BlockReader & operator=(const BlockReader &) = delete;
+
+    /// moves the next block of the input (block_size bytes, fewer only at
+    /// the end or from a pipe) into block; returns false at the end of the
+    /// input, throws fatal_error on a read error
+    bool next(std::string & block);
+    /// true if the reads go through io_uring
+    bool async() const { return ring_ != nullptr; }
+
+private:
+    struct Slot {
+        std::string buf;
+        int64_t offset = 0;
+        size_t got = 0;
+        bool in_flight = false, done = false;
+    };
+    int fd_;
+    size_t block_size_;
+    std::unique_ptr<IoUring> ring_;
+    std::vector<Slot> slots_;
+    // slot holding the next block to hand out, and offset of the next read
+    size_t front_ = 0;
+    int64_t next_offset_ = 0;
+    bool eof_ = false;
+
+    void issue(size_t i);
+    void reap();
+};
+
+/// output stream buffer writing to a file descriptor in big blocks, double
+/// buffered: a full block is written with io_uring while the next one is
+/// being filled, so formatting does not wait for the write unless it gets a
+/// whole block ahead. Falls back to blocking write() calls when io_uring is
+/// unavailable
+///
+/// example:
+///   BlockWriter buf(1, 1 << 20);
+///   std::ostream out(&buf);
+///   print_procs(out, procs);
+///   buf.finish();
+class BlockWriter : public std::streambuf {
+public:
+    BlockWriter(int fd, size_t block_size, bool use_io_uring = true);
+    /// finishes the writes; errors are ignored, call finish() to see them
+    ~BlockWriter() override;
+    BlockWriter(const BlockWriter &) = delete;
+    BlockWriter & operator=(const BlockWriter &) = delete;
+
+    /// writes out everything and waits for it; throws fatal_error if any
+    /// write failed
+    void finish();
+    /// true if the writes go through io_uring
+    bool async() const { return ring_ != nullptr; }
+
+protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+private:
+    int fd_;
+    std::unique_ptr<IoUring> ring_;
+    // bufs_[cur_] is being filled, the other one may be in flight
+    std::string bufs_[2];
+    int cur_ = 0;
+    // the part of the in-flight buffer not written yet
+    const char * pending_ = nullptr;
+    size_t pending_len_ = 0;
+    std::string error_;
+
+    void submit();
+    void wait();
+};
@@ -0,0 +1,182 @@
+#include "sched_api.h"
+#include "huge_pages.h"
+#include "jobs.h"
+#include "scheduler.h"
+#include "time_math.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+struct sched_ctx {
+    // borrowed input columns
+    int64_t n = 0;
+    const int64_t * arrivals = nullptr;
+    const int64_t * bursts = nullptr;
+    // caller-owned outputs, if registered
+    int64_t * user_starts = nullptr;
+    int64_t * user_finishes = nullptr;
+    // owned outputs
+    std::vector<int64_t> starts, finishes;
+    std::vector<int> seq;
+    std::string error;
+
+    int fail(int code, const std::string & msg)
+    {
+        error = msg;
+        return code;
+    }
+};
+
+static_assert(sizeof(int) == sizeof(int32_t), "sched_seq() hands out the int vector as int32_t");
+
+int sched_abi_version(void) { return SCHED_ABI_VERSION; }
+
+sched_ctx * sched_create(void) { return new (std::nothrow) sched_ctx; }
+
+void sched_free(sched_ctx * ctx) { delete ctx; }
+
+int sched_load_columns(sched_ctx * ctx, int64_t n, const int64_t * arrivals, const int64_t * bursts)
+{
+    if (!ctx) return SCHED_EINVAL;
+    if (n < 0 || (n > 0 && (!arrivals || !bursts)))
+        return ctx->fail(SCHED_EINVAL, "sched_load_columns: bad arguments");
+    for (int64_t i = 0; i < n; i++) {
+        if (arrivals[i] < 0 || bursts[i] <= 0 || (i > 0 && arrivals[i] < arrivals[i - 1]))
+            return ctx->fail(SCHED_EINVAL,
+                "sched_load_columns: process " + std::to_string(i)
+                    + " has a negative arrival, non-positive burst or arrives out of order");
+    }
+    ctx->n = n;
+    ctx->arrivals = arrivals;
+    ctx->bursts = bursts;
+    ctx->seq.clear();
+    ctx->error.clear();
+    return SCHED_OK;
+}
+
+int sched_set_output(sched_ctx * ctx, int64_t * starts, int64_t * finishes)
+{
+    if (!ctx) return SCHED_EINVAL;
+    if (!starts != !finishes)
+        return ctx->fail(SCHED_EINVAL, "sched_set_output: pass both arrays or neither");
+    ctx->user_starts = starts;
+    ctx->user_finishes = finishes;
+    return SCHED_OK;
+}
+
+int sched_run(sched_ctx * ctx, int64_t quantum, int64_t max_seq_len)
+{
+    if (!ctx) return SCHED_EINVAL;
+    if (quantum <= 0) return ctx->fail(SCHED_EINVAL, "sched_run: quantum must be positive");
+    if (max_seq_len < 0) return ctx->fail(SCHED_EINVAL, "sched_run: negative max_seq_len");
+    try {
+        int64_t * starts = ctx->user_starts;
+        int64_t * finishes = ctx->user_finishes;
+        if (!starts) {
+            reserve_huge(ctx->starts, ctx->n);
+            reserve_huge(ctx->finishes, ctx->n);
+            ctx->starts.resize(ctx->n);
+            ctx->finishes.resize(ctx->n);
+            starts = ctx->starts.data();
+            finishes = ctx->finishes.data();
+        }
+        simulate_rr_columns(quantum, max_seq_len, ctx->n, ctx->arrivals, ctx->bursts, starts,
+            finishes, ctx->seq, nullptr);
+    } catch (std::bad_alloc &) {
+        return ctx->fail(SCHED_ENOMEM, "sched_run: out of memory");
+    } catch (time_overflow_error & e) {
+        return ctx->fail(SCHED_EOVERFLOW, std::string("sched_run: ") + e.what());
+    } catch (std::exception & e) {
+        return ctx->fail(SCHED_EINTERNAL, std::string("sched_run: ") + e.what());
+    } catch (...) {
+        return ctx->fail(SCHED_EINTERNAL, "sched_run: unknown error");
+    }
+    ctx->error.clear();
+    return SCHED_OK;
+}
+
+const int64_t * sched_start_times(const sched_ctx * ctx)
+{
+    if (!ctx) return nullptr;
+    return ctx->user_starts ? ctx->user_starts : ctx->starts.data();
+}
+
+const int64_t * sched_finish_times(const sched_ctx * ctx)
+{
+    if (!ctx) return nullptr;
+    return ctx->user_finishes ? ctx->user_finishes : ctx->finishes.data();
+}
+
+const int32_t * sched_seq(const sched_ctx * ctx, int64_t * len)
+{
+    if (!ctx) {
+        if (len) *len = 0;
+        return nullptr;
+    }
+    if (len) *len = ctx->seq.size();
+    return reinterpret_cast<const int32_t *>(ctx->seq.data());
+}
+
+void sched_set_overflow_saturate(int saturate)
+{
+    set_overflow_policy(saturate ? OverflowPolicy::Saturate : OverflowPolicy::Error);
+}
+
+const char * sched_last_error(const sched_ctx * ctx) { return ctx ? ctx->error.c_str() : ""; }
+
+struct sched_executor {
+    SimExecutor executor;
+    explicit sched_executor(int nthreads) : executor(nthreads) {}
+};
+
+struct sched_job {
+    std::shared_future<int> status;
+};
+
+sched_executor * sched_executor_create(int nthreads)
+{
+    try {
+        return new sched_executor(nthreads);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sched_executor_free(sched_executor * ex) { delete ex; }
+
+sched_job * sched_submit(sched_executor * ex, sched_ctx * ctx, int64_t quantum,
+    int64_t max_seq_len, sched_callback callback, void * user)
+{
+    if (!ex || !ctx) return nullptr;
+    try {
+        auto promise = std::make_shared<std::promise<int>>();
+        std::unique_ptr<sched_job> job(new sched_job);
+        job->status = promise->get_future().share();
+        ex->executor.submit_task([=] {
+            int status = sched_run(ctx, quantum, max_seq_len);
+            if (callback) callback(ctx, status, user);
+            promise->set_value(status);
+        });
+        return job.release();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+int sched_job_done(const sched_job * job)
+{
+    if (!job) return 1;
+    return job->status.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+int sched_job_wait(sched_job * job)
+{
+    if (!job) return SCHED_EINVAL;
+    return job->status.get();
+}
+
+void sched_job_free(sched_job * job) { delete job; }
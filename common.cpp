@@ -1,7 +1,7 @@
 #include "common.h"
 
 #include <cctype>
-#include <chrono>
+#include <charconv>
 #include <iostream>
 
 using VS = std::vector<std::string>;
@@ -10,24 +10,23 @@ using VS = std::vector<std::string>;
 // the delimiters are 1 or more whitespaces
 VS split(const std::string& p_line)
 {
-    auto line = p_line + " ";
     VS res;
-    bool in_str = false;
-    std::string curr_word = "";
-    for (auto c : line) {
-        if (isspace(c)) {
-            if (in_str)
-                res.push_back(curr_word);
-            in_str = false;
-            curr_word = "";
-        } else {
-            curr_word.push_back(c);
-            in_str = true;
-        }
-    }
+    for (std::string_view w : Tokens(p_line))
+        res.emplace_back(w);
     return res;
 }
 
+size_t split_into(std::string_view str, std::string_view * toks, size_t max)
+{
+    size_t n = 0;
+    for (std::string_view w : Tokens(str)) {
+        if (n < max)
+            toks[n] = w;
+        n++;
+    }
+    return n;
+}
+
 std::string stdin_readline()
 {
     std::string result;
@@ -42,20 +41,58 @@ std::string stdin_readline()
     return result;
 }
 
+bool stdin_readline(std::string& line)
+{
+    line.clear();
+    while (1) {
+        int c = getc_unlocked(stdin);
+        if (c == -1)
+            break;
+        line.push_back(c);
+        if (c == '\n')
+            break;
+    }
+    return !line.empty();
+}
+
 std::string join(const VS& toks, const std::string& sep)
 {
     std::string res;
-    bool first = true;
-    for (auto& t : toks) {
-        res += (first ? "" : sep) + t;
-        first = false;
-    }
+    join_into(res, toks, sep);
     return res;
 }
 
-std::string simplify(const std::string& str) { return join(split(str)); }
+std::string simplify(const std::string& str)
+{
+    std::string res = str;
+    simplify_in_place(res);
+    return res;
+}
 
-bool is_alnum(const std::string& str)
+void simplify_in_place(std::string& str)
+{
+    // words only ever move to the left, so copying them over the start of
+    // the same buffer is safe
+    char* out = str.data();
+    for (std::string_view w : Tokens(str)) {
+        if (out != str.data())
+            *out++ = ' ';
+        std::char_traits<char>::move(out, w.data(), w.size());
+        out += w.size();
+    }
+    str.resize(out - str.data());
+}
+
+int64_t parse_int64(std::string_view tok)
+{
+    int64_t v;
+    auto r = std::from_chars(tok.data(), tok.data() + tok.size(), v);
+    if (r.ec == std::errc() && r.ptr == tok.data() + tok.size() && !tok.empty())
+        return v;
+    return std::stoll(std::string(tok));
+}
+
+bool is_alnum(std::string_view str)
 {
     for (int c : str)
         if (!isalnum(c))
@@ -63,31 +100,58 @@ bool is_alnum(const std::string& str)
     return true;
 }
 
-int Word2Int::get(const std::string& w)
+// FNV-1a, folded to 32 bits
+uint32_t Word2Int::hash(std::string_view w)
 {
-    auto f = myset.find(w);
-    if (f == myset.end()) {
-        myset[w] = counter;
-        counter++;
-        return counter - 1;
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : w) {
+        h ^= c;
+        h *= 1099511628211ull;
     }
-    return f->second;
+    return uint32_t(h ^ (h >> 32));
 }
 
-struct Timer::Pimpl {
-    std::chrono::time_point<std::chrono::steady_clock> start;
-};
-Timer::Timer() { pimpl_ = new Pimpl; reset(); }
-Timer::~Timer() { delete pimpl_; }
-double Timer::elapsed(bool reset_p)
+int Word2Int::find(std::string_view w) const
 {
-    double result =  1e-6
-        * std::chrono::duration_cast<std::chrono::microseconds>(
-              std::chrono::steady_clock::now() - pimpl_->start)
-              .count();
-    if( reset_p) reset();
-    return result;
+    if (slots_.empty()) return -1;
+    uint32_t h = hash(w);
+    size_t mask = slots_.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        const Slot & s = slots_[i];
+        if (s.id < 0) return -1;
+        if (s.hash == h && word(s.id) == w) return s.id;
+    }
+}
+
+int Word2Int::get(std::string_view w)
+{
+    if (2 * (ends_.size() + 1) > slots_.size()) grow();
+    uint32_t h = hash(w);
+    size_t mask = slots_.size() - 1;
+    size_t i = h & mask;
+    for (;; i = (i + 1) & mask) {
+        const Slot & s = slots_[i];
+        if (s.id < 0) break;
+        if (s.hash == h && word(s.id) == w) return s.id;
+    }
+    int id = ends_.size();
+    arena_.insert(arena_.end(), w.begin(), w.end());
+    ends_.push_back(arena_.size());
+    slots_[i].hash = h;
+    slots_[i].id = id;
+    return id;
+}
+
+// doubles the table; the stored hashes are reused, the words not touched
+void Word2Int::grow()
+{
+    std::vector<Slot> old(std::max<size_t>(16, 2 * slots_.size()));
+    old.swap(slots_);
+    size_t mask = slots_.size() - 1;
+    for (const Slot & s : old) {
+        if (s.id < 0) continue;
+        size_t i = s.hash & mask;
+        while (slots_[i].id >= 0) i = (i + 1) & mask;
+        slots_[i] = s;
+    }
 }
-void Timer::reset() {
-    pimpl_-> start= std::chrono::steady_clock::now();
-}
\ No newline at end of file
@@ -1,13 +1,27 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <ostream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 #include <sstream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
 
 /// reads in a line from stdin
 /// returns empty string on EOF
 /// return string includes trailing '\n' if present
 std::string stdin_readline();
+/// same, into line, reusing its buffer; returns false on EOF
+bool stdin_readline(std::string & line);
 
 /// splits string into tokens (words)
 /// separators are sequences of white spaces
@@ -21,7 +35,135 @@ std::string join(const std::vector<std::string>& toks, const std::string& sep =
 std::string simplify(const std::string& str);
 
 /// check if string is alphanumeric
-bool is_alnum(const std::string& str);
+bool is_alnum(std::string_view str);
+
+/// allocation-free text utilities
+/// ------------------------------------------------------------------
+/// these work on std::string_view and caller-owned buffers, so parsing a
+/// line costs no heap allocation; white space is what isspace() accepts in
+/// the C locale (' ', '\t', '\n', '\v', '\f', '\r'), and the scans test 16
+/// bytes at a time with SSE2 where available
+
+inline bool is_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+#if defined(__SSE2__)
+// bit i set if p[i] is white space, for the 16 bytes at p
+inline unsigned space_mask16(const char * p)
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    // bytes >= 0x80 compare as negative, so they are not in '\t'..'\r'
+    __m128i ctl = _mm_and_si128(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+    return _mm_movemask_epi8(_mm_or_si128(sp, ctl));
+}
+#endif
+
+/// first character in [p, end) that is not white space, or end
+inline const char * skip_space(const char * p, const char * end)
+{
+#if defined(__SSE2__)
+    for (; end - p >= 16; p += 16) {
+        unsigned m = ~space_mask16(p) & 0xffff;
+        if (m) return p + __builtin_ctz(m);
+    }
+#endif
+    while (p < end && is_space(*p)) p++;
+    return p;
+}
+
+/// first white space character in [p, end), or end
+inline const char * find_space(const char * p, const char * end)
+{
+#if defined(__SSE2__)
+    for (; end - p >= 16; p += 16) {
+        unsigned m = space_mask16(p);
+        if (m) return p + __builtin_ctz(m);
+    }
+#endif
+    while (p < end && !is_space(*p)) p++;
+    return p;
+}
+
+/// the words of a string, as views into it, so nothing is copied; the
+/// string must outlive the iteration
+///
+/// example:
+///   for (std::string_view w : Tokens(" hello  world\n")) ...
+///   // w = "hello", then "world"
+class Tokens {
+public:
+    explicit Tokens(std::string_view str) : begin_(str.data()), end_(str.data() + str.size()) {}
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view *;
+        using reference = std::string_view;
+
+        iterator() = default;
+        iterator(const char * p, const char * end) : end_(end) { find(p); }
+        std::string_view operator*() const { return std::string_view(word_, word_end_ - word_); }
+        iterator & operator++()
+        {
+            find(word_end_);
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const iterator & that) const { return word_ == that.word_; }
+        bool operator!=(const iterator & that) const { return word_ != that.word_; }
+
+    private:
+        const char * word_ = nullptr;
+        const char * word_end_ = nullptr;
+        const char * end_ = nullptr;
+
+        void find(const char * p)
+        {
+            word_ = skip_space(p, end_);
+            word_end_ = find_space(word_, end_);
+        }
+    };
+    iterator begin() const { return iterator(begin_, end_); }
+    iterator end() const { return iterator(end_, end_); }
+
+private:
+    const char * begin_;
+    const char * end_;
+};
+
+/// stores views of the first max words of str in toks and returns the
+/// number of words in str, which is more than max if some did not fit
+size_t split_into(std::string_view str, std::string_view * toks, size_t max);
+
+/// appends the words of toks to out, separated by sep; reusing out keeps
+/// this free of allocations once its capacity suffices
+template <class Range>
+void join_into(std::string & out, const Range & toks, std::string_view sep = " ")
+{
+    bool first = true;
+    for (const auto & t : toks) {
+        if (!first) out += sep;
+        out += t;
+        first = false;
+    }
+}
+
+/// simplify() in place: the words of str are moved to the front, separated
+/// by single spaces, and str is shortened
+void simplify_in_place(std::string & str);
+
+/// parses a decimal integer like std::stoll(std::string(tok)), which is
+/// only called (to get its exact behavior and exceptions) if tok is not a
+/// plain number
+int64_t parse_int64(std::string_view tok);
 
 /// HIDDEN HINT: this "may" help you get a bit more performance
 /// in your cycle finding algorithm, since indexed arrays are faster
@@ -31,34 +173,246 @@ bool is_alnum(const std::string& str);
 /// utility class you can use to convert words to unique integers
 /// get(word) returns the same number given the same word
 ///           the numbers will start at 0, then 1, 2, ...
+/// word(number) returns the word back
+///
+/// the words are stored back to back in one growing byte arena and looked
+/// up in an open-addressing hash table (linear probing) of word numbers,
+/// so interning a word costs no allocation of its own, and a lookup is
+/// usually a single probe and memcmp
 ///
 /// example:
 ///   Word2Int w2i;
 ///   w2i.get("hello") = 0
 ///   w2i.get("world") = 1
 ///   w2i.get("hello") = 0
+///   w2i.word(1) = "world"
 ///
 class Word2Int {
-    int counter = 0;
-    std::unordered_map<std::string, int> myset;
-
 public:
-    int get(const std::string& w);
+    int get(std::string_view w);
+    /// number of w, or -1 if it was never added
+    int find(std::string_view w) const;
+    /// the word with number id; points into the arena, so it is only valid
+    /// until the next get() of a new word
+    std::string_view word(int id) const
+    {
+        size_t start = id ? ends_[id - 1] : 0;
+        return std::string_view(arena_.data() + start, ends_[id] - start);
+    }
+    /// number of distinct words
+    int size() const { return ends_.size(); }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        // word number, -1 = empty
+        int id = -1;
+    };
+    // the bytes of all words, and where each one ends
+    std::vector<char> arena_;
+    std::vector<size_t> ends_;
+    // power of two size, at most half full
+    std::vector<Slot> slots_;
+
+    static uint32_t hash(std::string_view w);
+    void grow();
 };
 
 /// timer class for measuring elapsed time
+///
+/// header-only, reads CLOCK_MONOTONIC with nanosecond resolution and does
+/// not allocate, so it is cheap enough to wrap around microsecond-sized runs
 struct Timer {
     // return elapsed time (in seconds) since last reset/or construction
     // reset_p = true will reset the time
-    double elapsed(bool reset_p = false);
+    double elapsed(bool reset_p = false) { return 1e-9 * elapsed_ns(reset_p); }
+    // same as elapsed(), but in nanoseconds
+    int64_t elapsed_ns(bool reset_p = false)
+    {
+        int64_t now = now_ns();
+        int64_t result = now - start_;
+        if (reset_p) start_ = now;
+        return result;
+    }
     // reset the time to 0
-    void reset();
-    Timer();
-    ~Timer();
+    void reset() { start_ = now_ns(); }
+    Timer() { reset(); }
+
+    // current CLOCK_MONOTONIC time in nanoseconds
+    static int64_t now_ns()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
 
 private:
-    struct Pimpl;
-    Pimpl* pimpl_;
+    int64_t start_;
+};
+
+/// timer based on the CPU timestamp counter, for the shortest measurements
+///
+/// reading the TSC costs a few nanoseconds, versus ~20ns for clock_gettime;
+/// ticks are converted to seconds using a one-time calibration against
+/// CLOCK_MONOTONIC (about 5ms, done on first use). On machines without an
+/// invariant TSC (checked with CPUID, on first use) or non-x86 it falls
+/// back to Timer::now_ns().
+struct CycleTimer {
+    // return elapsed time (in seconds) since last reset/or construction
+    double elapsed(bool reset_p = false) { return 1e-9 * elapsed_ns(reset_p); }
+    // elapsed time in nanoseconds, converted from ticks; the ticks are read
+    // first so the first call's calibration is not part of the interval
+    double elapsed_ns(bool reset_p = false)
+    {
+        uint64_t t = elapsed_ticks(reset_p);
+        return t * ns_per_tick();
+    }
+    // raw elapsed ticks
+    uint64_t elapsed_ticks(bool reset_p = false)
+    {
+        uint64_t now = ticks();
+        uint64_t result = now - start_;
+        if (reset_p) start_ = now;
+        return result;
+    }
+    void reset() { start_ = ticks(); }
+    CycleTimer() { reset(); }
+
+    static uint64_t ticks()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (invariant_tsc()) return __builtin_ia32_rdtsc();
+#endif
+        return Timer::now_ns();
+    }
+    // whether the TSC ticks at a constant rate in all power states, so it
+    // can measure time (CPUID leaf 0x80000007, EDX bit 8)
+    static bool invariant_tsc()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        static const bool invariant = [] {
+            unsigned a, b, c, d;
+            return __get_cpuid(0x80000007, &a, &b, &c, &d) && (d & (1u << 8));
+        }();
+        return invariant;
+#else
+        return false;
+#endif
+    }
+    // nanoseconds per tick, calibrated once
+    static double ns_per_tick()
+    {
+        static const double ratio = calibrate();
+        return ratio;
+    }
+
+private:
+    uint64_t start_;
+
+    static double calibrate()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (!invariant_tsc()) return 1.0;
+        int64_t t0 = Timer::now_ns();
+        uint64_t c0 = ticks();
+        while (Timer::now_ns() - t0 < 5000000) {}
+        int64_t t1 = Timer::now_ns();
+        uint64_t c1 = ticks();
+        if (c1 > c0) return double(t1 - t0) / double(c1 - c0);
+#endif
+        return 1.0;
+    }
+};
+
+/// accumulates repeated measurements (laps) of the same operation
+///
+/// keeps count/min/max/mean/stddev and a log-linear histogram (each power
+/// of two nanoseconds is split into 8 equal buckets, so percentiles are
+/// accurate to ~12%); recording a lap never allocates
+///
+/// example:
+///   LapStats st;
+///   Timer t;
+///   for (...) { work(); st.add(t.elapsed_ns(true)); }
+///   st.print(std::cout);
+///
+class LapStats {
+public:
+    void add(double ns)
+    {
+        if (ns < 0) ns = 0;
+        n_++;
+        sum_ += ns;
+        sumsq_ += ns * ns;
+        if (n_ == 1 || ns < min_) min_ = ns;
+        if (n_ == 1 || ns > max_) max_ = ns;
+        hist_[bucket(uint64_t(ns))]++;
+    }
+    int64_t count() const { return n_; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+    double mean() const { return n_ ? sum_ / n_ : 0; }
+    double stddev() const
+    {
+        if (n_ < 2) return 0;
+        double var = (sumsq_ - sum_ * sum_ / n_) / (n_ - 1);
+        return var > 0 ? std::sqrt(var) : 0;
+    }
+    // approximate percentile (0..100), interpolated inside the histogram bucket
+    double percentile(double pct) const
+    {
+        if (n_ == 0) return 0;
+        double target = pct / 100 * n_;
+        int64_t seen = 0;
+        for (int b = 0; b < NBUCKETS; b++) {
+            if (hist_[b] == 0) continue;
+            if (seen + hist_[b] >= target) {
+                double lo = double(bucket_lo(b));
+                double r = lo + double(bucket_lo(b + 1) - lo) * (target - seen) / hist_[b];
+                return std::min(std::max(r, min_), max_);
+            }
+            seen += hist_[b];
+        }
+        return max_;
+    }
+    // prints a summary and the non-empty histogram buckets
+    void print(std::ostream & os, const char * label = "lap") const
+    {
+        std::ios_base::fmtflags f = os.flags();
+        os << std::fixed << std::setprecision(1) << label << ": n=" << n_ << " min=" << min_
+           << "ns mean=" << mean() << "ns stddev=" << stddev() << "ns p50=" << percentile(50)
+           << "ns p99=" << percentile(99) << "ns max=" << max_ << "ns\n";
+        for (int b = 0; b < NBUCKETS; b++) {
+            if (hist_[b] == 0) continue;
+            os << "  [" << std::setw(12) << bucket_lo(b) << ", " << std::setw(12)
+               << bucket_lo(b + 1) << ") ns " << std::setw(10) << hist_[b] << " "
+               << std::string(std::max<int64_t>(1, 40 * hist_[b] / n_), '#') << "\n";
+        }
+        os.flags(f);
+    }
+
+private:
+    enum { SUB = 8, OCTAVES = 48, NBUCKETS = SUB * OCTAVES };
+    int64_t n_ = 0;
+    double sum_ = 0, sumsq_ = 0, min_ = 0, max_ = 0;
+    int64_t hist_[NBUCKETS] = {};
+
+    // values below SUB get one bucket each, above that octave o (2^o..2^(o+1))
+    // is split into SUB buckets starting at index o*SUB
+    static int bucket(uint64_t v)
+    {
+        if (v < SUB) return int(v);
+        int o = 63 - __builtin_clzll(v);
+        if (o >= OCTAVES) return NBUCKETS - 1;
+        return o * SUB + int((v >> (o - 3)) & (SUB - 1));
+    }
+    static uint64_t bucket_lo(int b)
+    {
+        if (b < SUB) return b;
+        int o = b / SUB;
+        if (o < 3) return SUB;
+        return (uint64_t(1) << o) + uint64_t(b % SUB) * (uint64_t(1) << (o - 3));
+    }
 };
 
 
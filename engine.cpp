@@ -0,0 +1,186 @@
+#include "engine.h"
+#include "common.h"
+#include "online.h"
+#include "time_math.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// thresholds below were measured on 150k-300k process inputs: the Step and
+// Skip engines pay O(ready queue) for each slice and skip check, so OnlineRR
+// wins by 10-100x once many processes are in the system at once, and loses
+// by about 2x otherwise
+static const int64_t kOnlineConcurrency = 256;
+// the Small engine's fixed arrays hold this many processes
+static const int64_t kSmallProcs = 64;
+// bursts this many quanta long at the 90th percentile make skipping pay off
+static const int64_t kSkipQuanta = 4;
+// the Parallel engine runs Skip on each part, which needs enough busy
+// periods to spread over the threads
+static const int kParallelMinThreads = 2;
+static const int64_t kPeriodsPerThread = 4;
+static const int64_t kParallelMinProcs = 1 << 15;
+
+const char * engine_name(Engine e)
+{
+    switch (e) {
+    case Engine::Small: return "small";
+    case Engine::Step: return "step";
+    case Engine::Skip: return "skip";
+    case Engine::Online: return "online";
+    case Engine::Parallel: return "parallel";
+    default: return "auto";
+    }
+}
+
+Engine parse_engine(const std::string & name)
+{
+    for (Engine e : { Engine::Auto, Engine::Small, Engine::Step, Engine::Skip, Engine::Online, Engine::Parallel })
+        if (name == engine_name(e)) return e;
+    throw fatal_error() << "unknown engine '" << name
+                        << "', expected auto, small, step, skip, online or parallel";
+}
+
+int64_t WorkloadProfile::quanta_percentile(double p) const
+{
+    int64_t need = std::max<int64_t>(1, std::ceil(p * n)), seen = 0;
+    for (int k = 0; k < kBuckets; k++) {
+        seen += quanta_hist[k];
+        if (seen >= need) return int64_t(1) << k;
+    }
+    return 0;
+}
+
+WorkloadProfile profile_workload(int64_t quantum, const std::vector<Process> & processes)
+{
+    WorkloadProfile prof;
+    int64_t n = processes.size();
+    prof.n = n;
+    if (n == 0 || quantum <= 0) return prof;
+    prof.arrival_span = processes[n - 1].arrival_time - processes[0].arrival_time;
+
+    // branch-free checks, kept apart from the sequential scans below so the
+    // compiler can vectorise them
+    int64_t unsorted = 0, min_burst = processes[0].burst;
+    for (int64_t i = 1; i < n; i++)
+        unsorted += processes[i].arrival_time < processes[i - 1].arrival_time;
+    for (int64_t i = 0; i < n; i++) min_burst = std::min(min_burst, processes[i].burst);
+    prof.well_formed = unsorted == 0 && min_burst > 0 && processes[0].arrival_time >= 0;
+    if (!prof.well_formed) return prof;
+    for (int64_t i = 0; i < n; i++) {
+        int64_t b = processes[i].burst;
+        prof.total_burst = time_add(prof.total_burst, b);
+        uint64_t quanta = b / quantum + (b % quantum != 0);
+        prof.quanta_hist[quanta <= 1 ? 0 : std::bit_width(quanta - 1)]++;
+    }
+
+    // the CPU is idle before process i iff it arrives after the busy end of
+    // all earlier ones
+    int64_t end = -1, period_procs = 0;
+    for (int64_t i = 0; i < n; i++) {
+        int64_t a = processes[i].arrival_time, b = processes[i].burst;
+        if (a > end) {
+            prof.busy_periods++;
+            period_procs = 0;
+        }
+        prof.peak_backlog = std::max(prof.peak_backlog, time_add(std::max<int64_t>(end - a, 0), b));
+        end = time_add(std::max(end, a), b);
+        prof.max_period_procs = std::max(prof.max_period_procs, ++period_procs);
+    }
+    double mean_burst = double(prof.total_burst) / n;
+    prof.peak_concurrency
+        = std::min<int64_t>(prof.max_period_procs, std::ceil(prof.peak_backlog / mean_burst));
+    return prof;
+}
+
+Engine choose_engine(const WorkloadProfile & prof, int nthreads, bool observed, std::string & reason)
+{
+    if (!prof.well_formed) {
+        reason = "unsorted arrivals or non-positive bursts";
+        return Engine::Skip;
+    }
+    if (!observed && prof.n <= kSmallProcs) {
+        reason = std::to_string(prof.n) + " processes";
+        return Engine::Small;
+    }
+    if (!observed && nthreads >= kParallelMinThreads && prof.n >= kParallelMinProcs
+        && prof.busy_periods >= kPeriodsPerThread * nthreads
+        && prof.max_period_procs * 2 <= prof.n) {
+        reason = std::to_string(prof.busy_periods) + " busy periods over "
+            + std::to_string(nthreads) + " threads";
+        return Engine::Parallel;
+    }
+    if (!observed && prof.peak_concurrency >= kOnlineConcurrency) {
+        reason = "about " + std::to_string(prof.peak_concurrency) + " processes at once";
+        return Engine::Online;
+    }
+    int64_t p90 = prof.quanta_percentile(0.9);
+    if (p90 < kSkipQuanta) {
+        reason = "90% of bursts fit in " + std::to_string(p90) + " quanta";
+        return Engine::Step;
+    }
+    reason = "90% of bursts need up to " + std::to_string(p90) + " quanta";
+    return Engine::Skip;
+}
+
+void print_profile(std::ostream & os, const WorkloadProfile & prof)
+{
+    os << "processes        = " << prof.n << "\n"
+       << "arrival span     = " << prof.arrival_span << "\n"
+       << "total burst      = " << prof.total_burst << "\n"
+       << "quanta p50/p90/max = " << prof.quanta_percentile(0.5) << "/"
+       << prof.quanta_percentile(0.9) << "/" << prof.quanta_percentile(1) << "\n"
+       << "busy periods     = " << prof.busy_periods << "\n"
+       << "largest period   = " << prof.max_period_procs << " processes\n"
+       << "peak backlog     = " << prof.peak_backlog << "\n"
+       << "peak concurrency ~ " << prof.peak_concurrency << "\n";
+}
+
+// simulate_rr() on OnlineRR, pushing the processes in order; returns false
+// without touching the outputs if the input is not well formed (see
+// WorkloadProfile), which OnlineRR rejects
+static bool simulate_online(
+    int64_t quantum, int64_t max_seq_len, std::vector<Process> & processes, std::vector<int> & seq)
+{
+    for (size_t i = 0; i < processes.size(); i++)
+        if (processes[i].burst <= 0
+            || processes[i].arrival_time < (i == 0 ? 0 : processes[i - 1].arrival_time))
+            return false;
+    OnlineRR sim(quantum, max_seq_len);
+    for (const Process & p : processes) {
+        sim.advance_to(p.arrival_time);
+        sim.push(p.arrival_time, p.burst);
+    }
+    sim.drain();
+    for (size_t i = 0; i < processes.size(); i++) {
+        processes[i].start_time = sim.process(i).start_time;
+        processes[i].finish_time = sim.process(i).finish_time;
+    }
+    seq = sim.seq();
+    return true;
+}
+
+void run_engine(Engine engine, int64_t quantum, int64_t max_seq_len,
+    std::vector<Process> & processes, std::vector<int> & seq, SimObserver * observer, int nthreads)
+{
+    switch (engine) {
+    case Engine::Small:
+        if (!simulate_rr_small(quantum, max_seq_len, processes, seq))
+            simulate_rr(quantum, max_seq_len, processes, seq, observer);
+        break;
+    case Engine::Step:
+        simulate_rr_stepping(quantum, max_seq_len, processes, seq, observer);
+        break;
+    case Engine::Online:
+        if (!simulate_online(quantum, max_seq_len, processes, seq))
+            simulate_rr(quantum, max_seq_len, processes, seq, observer);
+        break;
+    case Engine::Parallel:
+        simulate_rr_parallel(quantum, max_seq_len, processes, seq, nthreads);
+        break;
+    default:
+        simulate_rr(quantum, max_seq_len, processes, seq, observer);
+        break;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "scheduler.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// the round-robin engines available to run_engine()
+enum class Engine {
+    // decide from profile_workload(), see choose_engine()
+    Auto,
+    // simulate_rr_small(): stack-only, for at most 64 processes
+    Small,
+    // simulate_rr_stepping(): every time slice, no skipping
+    Step,
+    // simulate_rr(): skips runs of full rounds
+    Skip,
+    // OnlineRR: deque ready queue and amortised skip checks, for workloads
+    // with many processes in the system at once
+    Online,
+    // simulate_rr_parallel(): independent busy periods on several threads
+    Parallel,
+};
+
+/// "auto", "small", "step", "skip", "online" or "parallel"
+const char * engine_name(Engine e);
+/// inverse of engine_name(), throws fatal_error for unknown names
+Engine parse_engine(const std::string & name);
+
+/// summary of a workload computed by a single pass over the input, cheap
+/// compared to any simulation of it
+struct WorkloadProfile {
+    int64_t n = 0;
+    // last arrival - first arrival
+    int64_t arrival_span = 0;
+    // arrivals are non-decreasing and bursts positive (required by the
+    // Online engine)
+    bool well_formed = true;
+    int64_t total_burst = 0;
+    // histogram of ceil(burst / quantum): bucket 0 counts bursts of one
+    // quantum, bucket k > 0 those of (2^(k-1), 2^k] quanta
+    static const int kBuckets = 64;
+    int64_t quanta_hist[kBuckets] = {};
+    // smallest number of quanta covering the given fraction of bursts
+    // (rounded up to a power of two)
+    int64_t quanta_percentile(double p) const;
+    // periods of continuous CPU activity, separated by idle gaps; they do
+    // not depend on the scheduling policy
+    int64_t busy_periods = 0;
+    // processes in the largest busy period
+    int64_t max_period_procs = 0;
+    // most work (in time units) waiting for the CPU right after an arrival
+    int64_t peak_backlog = 0;
+    // peak_backlog in units of the mean burst: roughly how many processes
+    // are in the system at the busiest moment
+    int64_t peak_concurrency = 0;
+};
+
+WorkloadProfile profile_workload(int64_t quantum, const std::vector<Process> & processes);
+
+/// picks an engine for the profiled workload, given the number of threads
+/// available and whether an observer must be supported (only Step and Skip
+/// call it); reason is set to a short explanation of the choice
+Engine choose_engine(const WorkloadProfile & prof, int nthreads, bool observed, std::string & reason);
+
+/// prints the profile, one "name = value" per line
+void print_profile(std::ostream & os, const WorkloadProfile & prof);
+
+/// runs the simulation with the given engine (not Auto); observer is
+/// ignored by Small, Online and Parallel, nthreads is only used by
+/// Parallel; Small and Online fall back to Skip for inputs they cannot
+/// handle (Online: inputs that are not well_formed)
+void run_engine(Engine engine, int64_t quantum, int64_t max_seq_len,
+    std::vector<Process> & processes, std::vector<int> & seq, SimObserver * observer, int nthreads);
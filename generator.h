@@ -0,0 +1,108 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+/// lazy sequence produced by a C++20 coroutine: the body runs only when the
+/// next value is requested, and is suspended at each co_yield
+///
+/// example:
+///   Generator<int> count(int n) { for (int i = 0; i < n; i++) co_yield i; }
+///   for (int x : count(10)) ...
+///
+/// or, pulling values one at a time:
+///   auto g = count(10);
+///   while (g.next()) use(g.value());
+///
+/// an exception thrown by the coroutine body is rethrown by next()
+template <class T>
+class Generator {
+public:
+    struct promise_type {
+        T * current = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object()
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        // the yielded value lives in the suspended coroutine frame until the
+        // body is resumed, so only a pointer to it is kept
+        std::suspend_always yield_value(T & value) noexcept
+        {
+            current = &value;
+            return {};
+        }
+        std::suspend_always yield_value(T && value) noexcept
+        {
+            current = &value;
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Generator() = default;
+    Generator(Generator && that) noexcept : h_(std::exchange(that.h_, nullptr)) {}
+    Generator & operator=(Generator && that) noexcept
+    {
+        if (this != &that) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(that.h_, nullptr);
+        }
+        return *this;
+    }
+    Generator(const Generator &) = delete;
+    Generator & operator=(const Generator &) = delete;
+    ~Generator()
+    {
+        if (h_) h_.destroy();
+    }
+
+    /// runs the coroutine up to its next co_yield; returns false once it
+    /// has finished
+    bool next()
+    {
+        if (!h_ || h_.done()) return false;
+        h_.resume();
+        if (h_.promise().error) std::rethrow_exception(std::exchange(h_.promise().error, nullptr));
+        return !h_.done();
+    }
+    /// the value of the last successful next()
+    T & value() const { return *h_.promise().current; }
+
+    struct sentinel {};
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        explicit iterator(Generator * g) : g_(g) {}
+        T & operator*() const { return g_->value(); }
+        iterator & operator++()
+        {
+            if (!g_->next()) g_ = nullptr;
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(sentinel) const { return g_ == nullptr; }
+
+    private:
+        Generator * g_;
+    };
+    /// starts the iteration; a generator can only be iterated once
+    iterator begin()
+    {
+        iterator it(this);
+        return ++it;
+    }
+    sentinel end() { return {}; }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> h) : h_(h) {}
+    std::coroutine_handle<promise_type> h_;
+};
@@ -0,0 +1,20 @@
+#include "huge_pages.h"
+
+#include <cstdint>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+void advise_huge_pages(void * p, size_t bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (!p || bytes < kHugePageMinBytes) return;
+    constexpr uintptr_t kHuge = uintptr_t(2) << 20;
+    uintptr_t lo = (uintptr_t(p) + kHuge - 1) & ~(kHuge - 1);
+    uintptr_t hi = (uintptr_t(p) + bytes) & ~(kHuge - 1);
+    // failure (e.g. THP disabled) just leaves normal pages
+    if (lo < hi) madvise(reinterpret_cast<void *>(lo), hi - lo, MADV_HUGEPAGE);
+#else
+    (void)p, (void)bytes;
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/// transparent huge pages for the big arrays of a simulation
+///
+/// with 10^8 processes the input/result records and the engines' queues
+/// take gigabytes, and walking them with 4 KiB pages is dominated by TLB
+/// misses. advise_huge_pages() asks the kernel to back a fresh buffer with
+/// 2 MiB pages (madvise(MADV_HUGEPAGE), which is what the common "madvise"
+/// THP setting waits for); it is a no-op for small buffers, on kernels
+/// without THP and on other systems.
+///
+/// the advice takes effect when the pages are first touched, so it has to
+/// be given between allocating a buffer and filling it: reserve_huge() does
+/// that for a std::vector. The buffer still comes from operator new, so
+/// --mem keeps counting it, which means it is only fresh when malloc hands
+/// it out from a new mmap. glibc does that above its mmap threshold, which
+/// starts at 128 KiB but rises (up to 32 MiB on 64-bit) as large blocks are
+/// freed; below it a buffer may be recycled from the heap with its pages
+/// already touched, and then the advice only lets khugepaged collapse them
+/// in the background later. Buffers of hundreds of MiB, where the TLB
+/// misses matter, are always above the threshold.
+///
+/// first touch also decides the NUMA node of a page (the kernel's default
+/// policy puts it on the node of the touching thread), so a buffer that a
+/// worker thread allocates and fills itself ends up local to that worker
+/// without any explicit placement
+
+/// buffers smaller than this are left alone
+constexpr size_t kHugePageMinBytes = size_t(4) << 20;
+
+/// advises the 2 MiB-aligned part of [p, p + bytes) to use huge pages
+void advise_huge_pages(void * p, size_t bytes);
+
+/// like v.reserve(n), but advises the new buffer to use huge pages before
+/// the elements are moved into it
+template <class T>
+void reserve_huge(std::vector<T> & v, size_t n)
+{
+    if (n <= v.capacity()) return;
+    std::vector<T> bigger;
+    bigger.reserve(n);
+    advise_huge_pages(bigger.data(), n * sizeof(T));
+    bigger.insert(bigger.end(), std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()));
+    v.swap(bigger);
+}
+
+/// makes room for one more element in v, doubling it with reserve_huge()
+/// when full; call before push_back() on vectors that can grow very large
+template <class T>
+void grow_huge(std::vector<T> & v)
+{
+    if (v.size() == v.capacity()) reserve_huge(v, std::max<size_t>(16, 2 * v.capacity()));
+}
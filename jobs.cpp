@@ -0,0 +1,34 @@
+#include "jobs.h"
+
+#include <memory>
+#include <stdexcept>
+
+SimResult run_job(SimJob && job)
+{
+    SimResult r;
+    try {
+        if (job.quantum <= 0) throw std::invalid_argument("quantum must be positive");
+        simulate_rr(job.quantum, job.max_seq_len, job.processes, r.seq);
+        r.processes = std::move(job.processes);
+    } catch (std::exception & e) {
+        r.error = e.what();
+    }
+    return r;
+}
+
+std::future<SimResult> SimExecutor::submit(SimJob job)
+{
+    // std::function needs a copyable callable, so the promise and the job
+    // are shared rather than moved into the lambda
+    auto promise = std::make_shared<std::promise<SimResult>>();
+    auto shared_job = std::make_shared<SimJob>(std::move(job));
+    std::future<SimResult> result = promise->get_future();
+    pool_.submit([promise, shared_job] { promise->set_value(run_job(std::move(*shared_job))); });
+    return result;
+}
+
+void SimExecutor::submit(SimJob job, std::function<void(SimResult &&)> callback)
+{
+    auto shared_job = std::make_shared<SimJob>(std::move(job));
+    pool_.submit([shared_job, callback] { callback(run_job(std::move(*shared_job))); });
+}
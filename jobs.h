@@ -0,0 +1,54 @@
+#pragma once
+#include "scheduler.h"
+#include "thread_pool.h"
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+/// one simulation to run asynchronously
+struct SimJob {
+    int64_t quantum = 1;
+    int64_t max_seq_len = 0;
+    std::vector<Process> processes;
+};
+
+/// result of a SimJob: the processes with start/finish times filled in and
+/// the execution sequence, or a non-empty error
+struct SimResult {
+    std::vector<Process> processes;
+    std::vector<int> seq;
+    std::string error;
+};
+
+/// runs simulations concurrently on an internal work-stealing thread pool
+///
+/// example:
+///   SimExecutor ex;
+///   std::vector<std::future<SimResult>> fs;
+///   for (auto & job : jobs) fs.push_back(ex.submit(std::move(job)));
+///   for (auto & f : fs) use(f.get());
+///
+/// submit() never blocks on running jobs; a large job occupies one worker
+/// while the other workers keep draining the queue. The destructor waits
+/// for all submitted jobs.
+class SimExecutor {
+public:
+    /// nthreads <= 0 means one thread per hardware thread
+    explicit SimExecutor(int nthreads = 0) : pool_(nthreads) {}
+
+    /// queues job, the result is delivered through the future
+    std::future<SimResult> submit(SimJob job);
+    /// queues job, callback is called with the result on a worker thread
+    void submit(SimJob job, std::function<void(SimResult &&)> callback);
+    /// queues any task on the same pool (used by the C API)
+    void submit_task(std::function<void()> task) { pool_.submit(std::move(task)); }
+
+    int threads() const { return pool_.size(); }
+
+private:
+    ThreadPool pool_;
+};
+
+/// runs job synchronously; errors are reported in SimResult::error
+SimResult run_job(SimJob && job);
@@ -1,102 +1,598 @@
+#include "arrow_writer.h"
+#include "async_io.h"
 #include "common.h"
+#include "engine.h"
+#include "huge_pages.h"
+#include "memstats.h"
+#include "online.h"
+#include "perf.h"
+#include "pipeline.h"
+#include "progress.h"
+#include "report.h"
 #include "scheduler.h"
+#include "server.h"
+#include "shm_ring.h"
+#include "time_math.h"
+#include "trace.h"
+#include "workload.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <deque>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <memory>
 #include <numeric>
 #include <set>
+#include <thread>
 #include <vector>
 
 using VS = std::vector<std::string>;
 
-static void print_procs(const std::vector<Process> & procs, int indent = 0)
-{
-    std::string inds(indent, ' ');
-    std::cout << inds
-              << "+---------------------------+----------------------+----------------------+------"
-                 "----------------+\n"
-              << inds
-              << "| Id |              Arrival |                Burst |                Start |      "
-                 "         Finish |\n"
-              << inds
-              << "+---------------------------+----------------------+----------------------+------"
-                 "----------------+\n";
-    for (const auto & p : procs) {
-        std::cout << inds << "| " << std::setw(2) << std::right << p.id << " | " << std::setw(20)
-                  << p.arrival_time << " | " << std::setw(20) << p.burst << " | " << std::setw(20)
-                  << p.start_time << " | " << std::setw(20) << p.finish_time << " |"
-                  << "\n";
-    }
-    std::cout << inds
-              << "+---------------------------+----------------------+----------------------+------"
-                 "----------------+\n";
-}
+// command line options, given as --flags before the positional arguments
+struct RunOptions {
+    // report hardware performance counters for each phase of run_sched
+    bool perf = false;
+    // report allocations and peak memory for each phase of run_sched
+    bool mem = false;
+    // print a progress line to stderr every this many seconds (0 = off)
+    double progress_secs = 0;
+    // stop the simulation after this many seconds and print partial results
+    double time_budget_secs = 0;
+    // write the schedule as a Chrome trace-event JSON file
+    std::string trace_path;
+    // also write the results as an Arrow IPC file
+    std::string arrow_path;
+    // skipped rounds written slice by slice in the trace, per skip
+    int64_t trace_max_rounds = 1000;
+    // simulate incrementally while reading stdin (see run_online)
+    bool online = false;
+    // read, simulate and format in overlapping threads (see run_pipeline)
+    bool pipeline = false;
+    // let --pipeline read and write with io_uring when available
+    bool io_uring = true;
+    // synthetic workload specs and files to simulate instead of stdin (see
+    // run_generated)
+    VS generate_specs;
+    VS replay_paths;
+    // shared-memory ring to take the arrivals from instead of stdin (see
+    // run_shm)
+    std::string shm_name;
+    // simulation engine for run_sched (Auto = chosen from a profile of the
+    // input)
+    Engine engine = Engine::Auto;
+    // print the workload profile used to choose the engine
+    bool profile = false;
+    // serve simulation requests on this Unix socket instead of reading stdin
+    std::string serve_path;
+    // worker threads for --serve and the parallel engine (0 = one per
+    // hardware thread)
+    int threads = 0;
+    // re-run simulate_rr this many extra times and report lap statistics
+    int64_t repeat = 0;
+};
+
+// measures the phases of run_sched for --perf and --mem
+class PhaseProbe {
+public:
+    explicit PhaseProbe(const RunOptions & opts) : mem_(opts.mem)
+    {
+        // reserved up front so the bookkeeping does not show up in a phase
+        phases_.reserve(8);
+        if (mem_) mem_set_accounting(true);
+        // counters are only opened when requested, so the default run does
+        // not pay for the syscalls
+        if (opts.perf) {
+            perf_.reset(new PerfCounters);
+            if (!perf_->error().empty()) std::cout << "perf: " << perf_->error() << "\n";
+        }
+    }
+    bool enabled() const { return perf_ || mem_; }
+    void begin(const std::string & name)
+    {
+        if (!enabled()) return;
+        phases_.emplace_back();
+        phases_.back().name = name;
+        if (mem_) {
+            mem_reset_peak();
+            phases_.back().mem_before = mem_snapshot();
+        }
+        if (perf_) perf_->start();
+    }
+    void end()
+    {
+        if (!enabled()) return;
+        if (perf_) phases_.back().perf = perf_->stop();
+        if (mem_) phases_.back().mem_after = mem_snapshot();
+    }
+    void report(std::ostream & os, int64_t nprocs) const
+    {
+        if (!enabled()) return;
+        os << "\n";
+        for (const auto & ph : phases_)
+            if (perf_) print_perf(os, ph.name, ph.perf, nprocs);
+        for (const auto & ph : phases_)
+            if (mem_) print_mem(os, ph.name, ph.mem_before, ph.mem_after, nprocs);
+    }
 
-static int run_sched(int64_t quantum, int64_t max_seq_len)
+private:
+    struct Phase {
+        std::string name;
+        PerfSample perf;
+        MemSnapshot mem_before, mem_after;
+    };
+    std::unique_ptr<PerfCounters> perf_;
+    bool mem_;
+    std::vector<Phase> phases_;
+};
+
+static int run_sched(int64_t quantum, int64_t max_seq_len, const RunOptions & opts)
 {
+    PhaseProbe probe(opts);
+    probe.begin("read");
+
     std::cout << "Reading in lines from stdin...\n";
 
     // read in the process information from stdin
     int line_no = 0;
     std::vector<Process> processes;
-    while (1) {
-        // read in the next line and quit loop on EOF
-        auto line = stdin_readline();
-        if (line.size() == 0) break;
+    ProcessNames names;
+    std::string line;
+    // read in the next line and quit loop on EOF
+    while (stdin_readline(line)) {
         line_no++;
-        auto toks = split(line);
-        if (toks.size() == 0) continue;
+        // the records take gigabytes for big inputs, see huge_pages.h
+        grow_huge(processes);
         try {
-            if (toks.size() != 2) throw fatal_error() << "need 2 ints per line";
-            Process p;
-            p.id = processes.size();
-            p.arrival_time = std::stoll(toks[0]);
-            p.burst = std::stoll(toks[1]);
-            processes.push_back(p);
+            parse_process_line(line, processes, &names);
         } catch (std::exception & e) {
             std::cout << "Error on line " << line_no << ": " << e.what() << "\n";
             exit(-1);
         }
     }
 
+    probe.end();
+
+    // observers only work with the engines that call them
+    bool observed = opts.progress_secs > 0 || opts.time_budget_secs > 0 || !opts.trace_path.empty();
+    int nthreads = opts.threads > 0 ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+    Engine engine = opts.engine;
+    std::string reason = "requested";
+    if (engine == Engine::Auto || opts.profile) {
+        Timer ptimer;
+        WorkloadProfile prof = profile_workload(quantum, processes);
+        double secs = ptimer.elapsed();
+        if (engine == Engine::Auto) engine = choose_engine(prof, nthreads, observed, reason);
+        if (opts.profile) {
+            print_profile(std::cout, prof);
+            std::cout << "profile time     = " << std::fixed << std::setprecision(4) << secs
+                      << "s\n";
+        }
+    }
+    if (observed && engine != Engine::Step && engine != Engine::Skip) {
+        std::cout << "The " << engine_name(engine)
+                  << " engine cannot be combined with --progress, --time-budget or --trace\n";
+        return -1;
+    }
+
     std::cout << "Running simulate_rr(q=" << quantum << ",maxs=" << max_seq_len << ",procs=["
-              << processes.size() << "])\n";
+              << processes.size() << "],engine=" << engine_name(engine) << ": " << reason << ")\n";
     std::vector<int> seq { -2, 1000000, 5000 };
+    std::vector<Process> input;
+    if (opts.repeat > 0) input = processes;
     Timer timer;
-    simulate_rr(quantum, max_seq_len, processes, seq);
+    std::unique_ptr<ProgressMonitor> monitor;
+    if (opts.progress_secs > 0 || opts.time_budget_secs > 0)
+        monitor.reset(new ProgressMonitor(
+            std::cerr, processes.size(), opts.progress_secs, opts.time_budget_secs));
+    std::unique_ptr<ChromeTraceWriter> trace;
+    try {
+        if (!opts.trace_path.empty())
+            trace.reset(new ChromeTraceWriter(
+                opts.trace_path, processes.size(), opts.trace_max_rounds, monitor.get()));
+    } catch (std::exception & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    SimObserver * observer = monitor.get();
+    if (trace) observer = trace.get();
+    // opened before the simulation, so a bad path fails early
+    std::unique_ptr<ArrowResultWriter> arrow;
+    try {
+        if (!opts.arrow_path.empty()) arrow.reset(new ArrowResultWriter(opts.arrow_path));
+    } catch (std::exception & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    probe.begin("simulate");
+    run_engine(engine, quantum, max_seq_len, processes, seq, observer, nthreads);
+    try {
+        if (trace) trace->close();
+    } catch (std::exception & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    probe.end();
     std::cout << "Elapsed time  : " << std::fixed << std::setprecision(4) << timer.elapsed()
               << "s\n\n";
-    std::cout << "seq = [";
-    bool comma = false;
-    for (auto p : seq) {
-        if( comma) std::cout << ","; else comma = true;
-        std::cout << p;
+    if (monitor && monitor->cancelled())
+        std::cout << "Time budget exceeded: simulation stopped at time " << monitor->last_time()
+                  << " with " << monitor->last_finished() << " of " << processes.size()
+                  << " processes finished, results below are partial\n\n";
+    probe.begin("print");
+    const ProcessNames * out_names = names.empty() ? nullptr : &names;
+    print_seq(std::cout, seq, out_names);
+    print_procs_parallel(std::cout, processes, nthreads, 0, out_names);
+
+    std::cout.flush();
+    probe.end();
+    if (arrow) {
+        probe.begin("arrow");
+        try {
+            for (const auto & p : processes) arrow->add(p);
+            arrow->close();
+        } catch (std::exception & e) {
+            std::cout << "Error: " << e.what() << "\n";
+            return -1;
+        }
+        probe.end();
+    }
+    probe.report(std::cout, processes.size());
+
+    if (opts.repeat > 0) {
+        // each lap simulates a fresh copy of the input, the copy is not timed
+        LapStats laps;
+        std::vector<Process> copy;
+        for (int64_t i = 0; i < opts.repeat; i++) {
+            copy = input;
+            CycleTimer ct;
+            run_engine(engine, quantum, max_seq_len, copy, seq, nullptr, nthreads);
+            laps.add(ct.elapsed_ns());
+        }
+        std::cout << "\n";
+        laps.print(std::cout, "simulate_rr");
     }
-    std::cout << "]\n";
-    print_procs(processes);
 
     return 0;
 }
+
+// prints the state of an online simulation on one line
+static void print_online_state(const OnlineRR & sim)
+{
+    std::cout << "t=" << sim.now() << " running=" << sim.running()
+              << " ready=" << sim.ready_count() << " completed=" << sim.completed() << "/"
+              << sim.size() << "\n";
+    std::cout.flush();
+}
+
+// shadows a live queue: each input line "arrival burst" advances the
+// simulation to the arrival and adds the process, "@ t" advances to time t
+// and prints the state, "?" prints the state; at EOF the simulation is run
+// to completion and printed like in run_sched
+static int run_online(int64_t quantum, int64_t max_seq_len)
+{
+    std::cout << "Running online simulation (q=" << quantum << ",maxs=" << max_seq_len
+              << "), reading arrivals from stdin...\n";
+    std::cout.flush();
+    OnlineRR sim(quantum, max_seq_len);
+    int line_no = 0;
+    std::string line;
+    std::string_view toks[2];
+    while (stdin_readline(line)) {
+        line_no++;
+        size_t ntoks = split_into(line, toks, 2);
+        if (ntoks == 0) continue;
+        try {
+            if (toks[0] == "?") {
+                print_online_state(sim);
+            } else if (toks[0] == "@") {
+                if (ntoks != 2) throw fatal_error() << "need a time after @";
+                sim.advance_to(parse_int64(toks[1]));
+                print_online_state(sim);
+            } else {
+                if (ntoks != 2) throw fatal_error() << "need 2 ints per line";
+                int64_t arrival = parse_int64(toks[0]);
+                sim.advance_to(arrival);
+                sim.push(arrival, parse_int64(toks[1]));
+            }
+        } catch (std::exception & e) {
+            std::cout << "Error on line " << line_no << ": " << e.what() << "\n";
+            exit(-1);
+        }
+    }
+    sim.drain();
+    std::cout << "\n";
+    print_seq(std::cout, sim.seq());
+    print_procs(std::cout, sim.processes());
+    return 0;
+}
+
+// reads, simulates and formats stdin in a pipeline of threads and prints
+// the same results as run_sched
+static int run_pipeline(int64_t quantum, int64_t max_seq_len, const RunOptions & opts)
+{
+    std::cout << "Running pipelined simulation (q=" << quantum << ",maxs=" << max_seq_len
+              << "), reading arrivals from stdin...\n";
+    std::cout.flush();
+    Timer timer;
+    PipelineResult res;
+    try {
+        std::unique_ptr<ArrowResultWriter> arrow;
+        if (!opts.arrow_path.empty()) arrow.reset(new ArrowResultWriter(opts.arrow_path));
+        res = simulate_pipelined(0, quantum, max_seq_len, opts.io_uring, arrow.get());
+        if (arrow) arrow->close();
+    } catch (input_error & e) {
+        std::cout << "Error on line " << e.line << ": " << e.what() << "\n";
+        exit(-1);
+    } catch (std::exception & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    double elapsed = timer.elapsed();
+    // the results go straight to stdout, a block is written while the next
+    // one is filled
+    std::cout.flush();
+    BlockWriter outbuf(1, 1 << 20, opts.io_uring);
+    std::ostream out(&outbuf);
+    out << "Elapsed time  : " << std::fixed << std::setprecision(4) << elapsed << "s\n\n";
+    print_seq(out, res.seq);
+    print_procs_header(out);
+    out.write(res.rows.data(), res.rows.size());
+    print_procs_footer(out);
+    try {
+        outbuf.finish();
+    } catch (std::exception & e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    return 0;
+}
+
+// summary statistics of the finished processes, printed by the modes that
+// do not keep the per-process table
+struct FinishStats {
+    int64_t count = 0;
+    double sum_turnaround = 0, sum_waiting = 0;
+    int64_t max_turnaround = 0, last_finish = 0;
+
+    void add(const Process & p)
+    {
+        count++;
+        int64_t turnaround = p.finish_time - p.arrival_time;
+        sum_turnaround += turnaround;
+        sum_waiting += turnaround - p.burst;
+        max_turnaround = std::max(max_turnaround, turnaround);
+        last_finish = p.finish_time;
+    }
+    void print(std::ostream & os) const
+    {
+        int64_t n = std::max<int64_t>(1, count);
+        os << "processes       = " << count << "\n"
+           << "last finish     = " << last_finish << "\n"
+           << "mean turnaround = " << std::fixed << std::setprecision(2) << sum_turnaround / n
+           << "\n"
+           << "mean waiting    = " << sum_waiting / n << "\n"
+           << "max turnaround  = " << max_turnaround << "\n";
+    }
+};
+
+// simulates the merge of the --generate and --replay sources, pulling one
+// arrival at a time, so the workload is never held in memory; prints the
+// sequence and summary statistics instead of the per-process table, and
+// with several sources, the statistics of each one
+static int run_generated(int64_t quantum, int64_t max_seq_len, const RunOptions & opts)
+{
+    std::vector<std::unique_ptr<std::ifstream>> files;
+    std::vector<Generator<Process>> sources;
+    VS names;
+    try {
+        for (auto & spec : opts.generate_specs) {
+            sources.push_back(synthetic_arrivals(SyntheticSpec::parse(spec)));
+            names.push_back(spec);
+        }
+        for (auto & path : opts.replay_paths) {
+            files.emplace_back(new std::ifstream(path));
+            if (!*files.back()) throw fatal_error() << "cannot open " << path;
+            sources.push_back(replay_arrivals(*files.back(), path));
+            names.push_back(path);
+        }
+    } catch (std::exception & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    // the merged processes carry the index of their source as id
+    Generator<Process> source = merge_arrivals(std::move(sources));
+
+    std::cout << "Running simulation on generated arrivals (q=" << quantum
+              << ",maxs=" << max_seq_len << ")\n";
+    std::cout.flush();
+    OnlineRR sim(quantum, max_seq_len);
+    sim.retain_finished = false;
+    FinishStats stats;
+    std::vector<FinishStats> source_stats(names.size());
+    // source of each process from first_src on that is still running, or
+    // -1 once it has finished; the finished prefix is dropped as it grows
+    std::deque<int> src_of;
+    int64_t first_src = 0;
+    sim.on_finish = [&](const Process & p) {
+        stats.add(p);
+        int & src = src_of[p.id - first_src];
+        source_stats[src].add(p);
+        src = -1;
+        while (!src_of.empty() && src_of.front() < 0) {
+            src_of.pop_front();
+            first_src++;
+        }
+    };
+    Timer timer;
+    try {
+        for (const Process & p : source) {
+            sim.advance_to(p.arrival_time);
+            sim.push(p.arrival_time, p.burst);
+            src_of.push_back(p.id);
+        }
+        sim.drain();
+    } catch (std::exception & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    std::cout << "Elapsed time  : " << std::fixed << std::setprecision(4) << timer.elapsed()
+              << "s\n\n";
+    print_seq(std::cout, sim.seq());
+    stats.print(std::cout);
+    if (names.size() > 1) {
+        for (size_t s = 0; s < names.size(); s++) {
+            std::cout << "\nsource " << s << ": " << names[s] << "\n";
+            source_stats[s].print(std::cout);
+        }
+    }
+    return 0;
+}
+
+// simulates the arrivals another process pushes into the shared-memory
+// ring opts.shm_name, reading the records in place until the producer
+// closes the ring; prints the sequence and summary statistics like
+// run_generated
+static int run_shm(int64_t quantum, int64_t max_seq_len, const RunOptions & opts)
+{
+    std::unique_ptr<ShmRing> ring;
+    try {
+        ring = ShmRing::attach(opts.shm_name);
+    } catch (std::exception & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    std::cout << "Running simulation on arrivals from " << opts.shm_name << " (q=" << quantum
+              << ",maxs=" << max_seq_len << ")\n";
+    std::cout.flush();
+    OnlineRR sim(quantum, max_seq_len);
+    sim.retain_finished = false;
+    FinishStats stats;
+    sim.on_finish = [&](const Process & p) { stats.add(p); };
+    Timer timer;
+    try {
+        auto feed = [&](const ShmRecord & r) {
+            sim.advance_to(r.arrival_time);
+            sim.push(r.arrival_time, r.burst);
+        };
+        while (ring->consume(feed)) {}
+        sim.drain();
+    } catch (std::exception & e) {
+        std::cout << "Error after " << sim.size() << " records: " << e.what() << "\n";
+        return -1;
+    }
+    std::cout << "Elapsed time  : " << std::fixed << std::setprecision(4) << timer.elapsed()
+              << "s\n\n";
+    print_seq(std::cout, sim.seq());
+    stats.print(std::cout);
+    return 0;
+}
+
 static int usage(const std::string & pname)
 {
     std::cout << "Usage:\n"
-              << "    " << pname << " quantum max_seq_len\n";
+              << "    " << pname << " [options] quantum max_seq_len\n"
+              << "    " << pname << " --serve SOCKET [--threads N]\n"
+              << "Options:\n"
+              << "    --perf        report hardware performance counters per phase\n"
+              << "    --mem         report allocations and peak memory per phase\n"
+              << "    --progress S  print a progress line to stderr every S seconds\n"
+              << "    --time-budget S  stop after S seconds, print partial results\n"
+              << "    --trace FILE  write the schedule as Chrome trace-event JSON\n"
+              << "    --trace-max-rounds N  expand at most N skipped rounds per skip\n"
+              << "    --arrow FILE  also write the results as an Arrow IPC file\n"
+              << "    --online      simulate incrementally as arrivals are read\n"
+              << "    --pipeline    read, simulate and format in overlapping threads\n"
+              << "    --no-io-uring  use blocking reads/writes in --pipeline mode\n"
+              << "    --generate SPEC  simulate synthetic arrivals instead of stdin, e.g.\n"
+              << "                  n=1000000,gap=exp:5,burst=uniform:1:50,seed=7\n"
+              << "    --replay FILE  simulate the arrivals in FILE instead of stdin\n"
+              << "    --shm NAME    simulate the arrivals pushed into the shared-memory ring\n"
+              << "                  NAME by another process (see shm_producer)\n"
+              << "    --engine E    simulation engine: auto (default), small, step, skip,\n"
+              << "                  online or parallel (splits one simulation over --threads\n"
+              << "                  threads)\n"
+              << "    --parallel    same as --engine parallel\n"
+              << "    --profile     print the workload profile used by --engine auto\n"
+              << "    --overflow P  on time overflow: error (default) or saturate\n"
+              << "    --serve SOCKET  serve simulation requests on a Unix socket\n"
+              << "    --threads N   worker threads (default: one per hardware thread)\n"
+              << "    --repeat N    re-run the simulation N times, report timing statistics\n";
     return -1;
 }
 
 static int cppmain(const VS & args)
 {
     // parse arguments
-    if (args.size() != 3)
-        return usage(args[0]);
-
+    RunOptions opts;
+    VS pos { args[0] };
     try {
-        int64_t quantum = std::stoll(args[1]);
-        int64_t max_seq_len = std::stoll(args[2]);
-        return run_sched(quantum, max_seq_len);
+        for (size_t i = 1; i < args.size(); i++) {
+            if (args[i] == "--perf")
+                opts.perf = true;
+            else if (args[i] == "--mem")
+                opts.mem = true;
+            else if (args[i] == "--progress" && i + 1 < args.size())
+                opts.progress_secs = std::stod(args[++i]);
+            else if (args[i] == "--time-budget" && i + 1 < args.size())
+                opts.time_budget_secs = std::stod(args[++i]);
+            else if (args[i] == "--trace" && i + 1 < args.size())
+                opts.trace_path = args[++i];
+            else if (args[i] == "--arrow" && i + 1 < args.size())
+                opts.arrow_path = args[++i];
+            else if (args[i] == "--trace-max-rounds" && i + 1 < args.size())
+                opts.trace_max_rounds = std::stoll(args[++i]);
+            else if (args[i] == "--online")
+                opts.online = true;
+            else if (args[i] == "--pipeline")
+                opts.pipeline = true;
+            else if (args[i] == "--no-io-uring")
+                opts.io_uring = false;
+            else if (args[i] == "--generate" && i + 1 < args.size())
+                opts.generate_specs.push_back(args[++i]);
+            else if (args[i] == "--replay" && i + 1 < args.size())
+                opts.replay_paths.push_back(args[++i]);
+            else if (args[i] == "--shm" && i + 1 < args.size())
+                opts.shm_name = args[++i];
+            else if (args[i] == "--engine" && i + 1 < args.size())
+                opts.engine = parse_engine(args[++i]);
+            else if (args[i] == "--parallel")
+                opts.engine = Engine::Parallel;
+            else if (args[i] == "--profile")
+                opts.profile = true;
+            else if (args[i] == "--overflow" && i + 1 < args.size()) {
+                std::string p = args[++i];
+                if (p != "error" && p != "saturate") throw fatal_error() << "bad --overflow";
+                set_overflow_policy(p == "error" ? OverflowPolicy::Error : OverflowPolicy::Saturate);
+            } else if (args[i] == "--serve" && i + 1 < args.size())
+                opts.serve_path = args[++i];
+            else if (args[i] == "--threads" && i + 1 < args.size())
+                opts.threads = std::stoi(args[++i]);
+            else if (args[i] == "--repeat" && i + 1 < args.size())
+                opts.repeat = std::stoll(args[++i]);
+            else if (args[i].size() > 2 && args[i].compare(0, 2, "--") == 0) {
+                std::cout << "Unknown option " << args[i] << "\n";
+                return usage(args[0]);
+            } else
+                pos.push_back(args[i]);
+        }
+        if (!opts.serve_path.empty() && pos.size() == 1)
+            return run_server(opts.serve_path, opts.threads);
+        if (pos.size() != 3)
+            return usage(args[0]);
+
+        int64_t quantum = std::stoll(pos[1]);
+        int64_t max_seq_len = std::stoll(pos[2]);
+        if (opts.online) return run_online(quantum, max_seq_len);
+        if (opts.pipeline) return run_pipeline(quantum, max_seq_len, opts);
+        if (!opts.shm_name.empty()) return run_shm(quantum, max_seq_len, opts);
+        if (!opts.generate_specs.empty() || !opts.replay_paths.empty())
+            return run_generated(quantum, max_seq_len, opts);
+        return run_sched(quantum, max_seq_len, opts);
+    } catch (time_overflow_error & e) {
+        std::cout << "Error: " << e.what() << "\n";
+        return -1;
     } catch (...) {
         std::cout << "Could not parse command line arguments.\n";
         return usage(args[0]);
@@ -0,0 +1,144 @@
+#include "memstats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <malloc.h>
+#include <new>
+#include <sstream>
+#include <unistd.h>
+
+// counters updated by the replacement operator new/delete below; relaxed
+// ordering is enough since they are only read for reporting
+static std::atomic<int64_t> g_allocs { 0 };
+static std::atomic<int64_t> g_frees { 0 };
+static std::atomic<int64_t> g_bytes { 0 };
+static std::atomic<int64_t> g_live { 0 };
+static std::atomic<int64_t> g_peak { 0 };
+// set by mem_set_accounting(); when off, operator new/delete are plain
+// malloc/free plus this one uncontended load
+static std::atomic<bool> g_accounting { false };
+
+void mem_set_accounting(bool on) { g_accounting.store(on, std::memory_order_relaxed); }
+bool mem_accounting() { return g_accounting.load(std::memory_order_relaxed); }
+
+static void * counted_alloc(size_t size)
+{
+    void * p = malloc(size ? size : 1);
+    if (!p || !g_accounting.load(std::memory_order_relaxed)) return p;
+    int64_t usable = malloc_usable_size(p);
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t live = g_live.fetch_add(usable, std::memory_order_relaxed) + usable;
+    int64_t peak = g_peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return p;
+}
+
+static void counted_free(void * p)
+{
+    if (!p) return;
+    if (!g_accounting.load(std::memory_order_relaxed)) return free(p);
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    g_live.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+    free(p);
+}
+
+void * operator new(size_t size)
+{
+    void * p = counted_alloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void * operator new[](size_t size)
+{
+    void * p = counted_alloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void * operator new(size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size); }
+void * operator new[](size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size); }
+void operator delete(void * p) noexcept { counted_free(p); }
+void operator delete[](void * p) noexcept { counted_free(p); }
+void operator delete(void * p, size_t) noexcept { counted_free(p); }
+void operator delete[](void * p, size_t) noexcept { counted_free(p); }
+
+// reads a "Key:   123 kB" line from /proc/self/status
+static int64_t proc_status_kb(const char * key)
+{
+    FILE * f = fopen("/proc/self/status", "r");
+    if (!f) return -1;
+    char line[256];
+    size_t klen = strlen(key);
+    int64_t result = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, klen) == 0 && line[klen] == ':') {
+            result = atoll(line + klen + 1);
+            break;
+        }
+    }
+    fclose(f);
+    return result;
+}
+
+MemSnapshot mem_snapshot()
+{
+    MemSnapshot s;
+    s.allocs = g_allocs.load(std::memory_order_relaxed);
+    s.frees = g_frees.load(std::memory_order_relaxed);
+    s.bytes_allocated = g_bytes.load(std::memory_order_relaxed);
+    // frees of blocks allocated before accounting was turned on can take
+    // the count below zero
+    s.live_bytes = std::max<int64_t>(0, g_live.load(std::memory_order_relaxed));
+    s.peak_live_bytes = g_peak.load(std::memory_order_relaxed);
+    s.rss_kb = proc_status_kb("VmRSS");
+    s.peak_rss_kb = proc_status_kb("VmHWM");
+    return s;
+}
+
+void mem_reset_peak()
+{
+    g_peak.store(g_live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    // "5" resets the peak RSS (VmHWM) of the process, see proc(5); silently
+    // ignored on kernels/containers that do not allow it
+    FILE * f = fopen("/proc/self/clear_refs", "w");
+    if (f) {
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+static std::string human_bytes(double b)
+{
+    static const char * units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+    int u = 0;
+    while (b >= 1024 && u < 4) {
+        b /= 1024;
+        u++;
+    }
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(u ? 1 : 0) << b << units[u];
+    return os.str();
+}
+
+void print_mem(std::ostream & os, const std::string & phase, const MemSnapshot & before,
+    const MemSnapshot & after, int64_t nprocs)
+{
+    int64_t allocs = after.allocs - before.allocs;
+    int64_t bytes = after.bytes_allocated - before.bytes_allocated;
+    int64_t peak = after.peak_live_bytes - before.live_bytes;
+    os << "mem  " << std::left << std::setw(10) << phase << std::right
+       << " allocs=" << std::setw(10) << allocs << " frees=" << std::setw(10)
+       << after.frees - before.frees << " allocated=" << std::setw(10) << human_bytes(bytes)
+       << " peak-heap=" << std::setw(10) << human_bytes(peak > 0 ? peak : 0)
+       << " live-after=" << std::setw(10) << human_bytes(after.live_bytes)
+       << " peak-rss=" << std::setw(10) << human_bytes(after.peak_rss_kb * 1024.0);
+    if (nprocs > 0)
+        os << " | per proc: allocs=" << std::fixed << std::setprecision(2)
+           << double(allocs) / nprocs << " bytes=" << double(bytes) / nprocs
+           << " peak-heap=" << double(peak > 0 ? peak : 0) / nprocs;
+    os << "\n";
+}
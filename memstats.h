@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/// snapshot of the process-wide memory counters
+///
+/// the allocation counters are maintained by the counting operator
+/// new/delete built into the scheduler binary (memstats.cpp), so they see
+/// every C++ heap allocation, including those made by the standard library,
+/// while mem_set_accounting(true) is in effect
+struct MemSnapshot {
+    // number of calls to operator new / operator delete so far
+    int64_t allocs = 0;
+    int64_t frees = 0;
+    // total bytes ever requested from operator new
+    int64_t bytes_allocated = 0;
+    // bytes currently allocated (as reported by malloc_usable_size)
+    int64_t live_bytes = 0;
+    // highest live_bytes seen since the last mem_reset_peak()
+    int64_t peak_live_bytes = 0;
+    // resident set size, current and high-water mark, in KiB
+    int64_t rss_kb = 0;
+    int64_t peak_rss_kb = 0;
+};
+
+/// turns the allocation counters on or off; they are off by default, so
+/// operator new/delete cost nothing extra unless --mem asks for them.
+/// Counting starts when turned on: blocks allocated before are not counted,
+/// and freeing them only lowers live_bytes (which stays >= 0)
+void mem_set_accounting(bool on);
+bool mem_accounting();
+
+/// reads the current counters
+MemSnapshot mem_snapshot();
+
+/// starts a new measurement phase: peak_live_bytes is reset to the current
+/// live_bytes, and the kernel's RSS high-water mark is reset if permitted
+void mem_reset_peak();
+
+/// prints the difference between two snapshots taken around a phase,
+/// normalized by the number of processes (nprocs <= 0 disables that column)
+void print_mem(std::ostream & os, const std::string & phase, const MemSnapshot & before,
+    const MemSnapshot & after, int64_t nprocs);
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+/// unbounded multi-producer single-consumer queue
+///
+/// a linked list where producers append with a single atomic exchange, so
+/// push() is lock-free: apart from allocating its node with new (which may
+/// take the allocator's locks), it never waits for the consumer or for
+/// another producer, however slow they are. Only one thread may pop. Items pushed
+/// by one thread are popped in the order they were pushed; items from
+/// different threads interleave in the order of their exchanges.
+///
+/// a push that has done its exchange but not yet linked its node hides the
+/// items behind it until it completes (a few instructions later), so
+/// try_pop() can briefly report an empty queue while another thread is in
+/// the middle of push(); callers that poll simply see them on the next try
+///
+/// each item costs one allocation, freed by the consumer
+template <class T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(new Node), tail_(head_.load()) {}
+    ~MpscQueue()
+    {
+        T item;
+        while (try_pop(item)) {}
+        delete tail_;
+    }
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue & operator=(const MpscQueue &) = delete;
+
+    /// any thread: appends item
+    void push(T item)
+    {
+        Node * n = new Node;
+        n->value = std::move(item);
+        Node * prev = head_.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+    /// consumer thread only: moves the oldest item out, if there is one
+    bool try_pop(T & item)
+    {
+        Node * next = tail_->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        item = std::move(next->value);
+        // next becomes the new dummy node, its value is dead
+        delete tail_;
+        tail_ = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next { nullptr };
+        T value {};
+    };
+    // last node, where producers append
+    alignas(64) std::atomic<Node *> head_;
+    // dummy node before the oldest item, owned by the consumer
+    alignas(64) Node * tail_;
+};
@@ -0,0 +1,189 @@
+#include "online.h"
+#include "common.h"
+#include "huge_pages.h"
+#include "time_math.h"
+
+#include <algorithm>
+#include <limits>
+
+OnlineRR::OnlineRR(int64_t quantum, int64_t max_seq_len)
+    : quantum_(quantum), max_seq_len_(max_seq_len)
+{
+    if (quantum <= 0) throw fatal_error() << "quantum must be positive";
+}
+
+int OnlineRR::push(int64_t arrival, int64_t burst)
+{
+    if (arrival < curr_time_ || arrival < last_arrival_)
+        throw fatal_error() << "arrival " << arrival << " is before the current time "
+                            << std::max(curr_time_, last_arrival_);
+    if (burst <= 0) throw fatal_error() << "burst must be positive";
+    Process p;
+    p.id = pushed_;
+    p.arrival_time = arrival;
+    p.burst = burst;
+    grow_huge(procs_);
+    grow_huge(remaining_);
+    procs_.push_back(p);
+    remaining_.push_back(burst);
+    pushed_++;
+    last_arrival_ = arrival;
+    // arriving right now: join the ready queue immediately, so queries see it
+    if (arrival == curr_time_) admit_until(curr_time_, true);
+    return p.id;
+}
+
+// moves pushed processes that arrived before t (or at t, if inclusive)
+// to the back of the ready queue
+void OnlineRR::admit_until(int64_t t, bool inclusive)
+{
+    while (admitted_ < pushed_) {
+        int64_t a = rec(admitted_).arrival_time;
+        if (a > t || (a == t && !inclusive)) break;
+        rq_.push_back(admitted_++);
+    }
+}
+
+void OnlineRR::push_seq(int id)
+{
+    if ((int64_t)seq_.size() < max_seq_len_ && (seq_.empty() || seq_.back() != id))
+        seq_.push_back(id);
+}
+
+void OnlineRR::start_slice()
+{
+    int p = rq_.front();
+    rq_.pop_front();
+    running_ = p;
+    slice_start_ = curr_time_;
+    slice_len_ = std::min(quantum_, rem(p));
+    slice_end_ = time_add(curr_time_, slice_len_);
+    if (rec(p).start_time == -1) rec(p).start_time = curr_time_;
+    push_seq(p);
+}
+
+// completes the running slice at slice_end_; the preempted process goes
+// back to the queue after processes that arrived during the slice but
+// before ones arriving exactly at slice_end_, like in simulate_rr()
+void OnlineRR::finish_slice()
+{
+    int p = running_;
+    running_ = -1;
+    rem(p) -= slice_len_;
+    curr_time_ = slice_end_;
+    if (observer && observer->wants_slices) observer->on_slice(p, slice_start_, slice_end_);
+    admit_until(curr_time_, false);
+    if (rem(p) == 0) {
+        rec(p).finish_time = curr_time_;
+        completed_++;
+        if (on_finish) on_finish(rec(p));
+        if (!retain_finished) release_finished();
+    } else {
+        rq_.push_back(p);
+    }
+    admit_until(curr_time_, true);
+}
+
+// if every queued process needs more than one quantum, runs as many full
+// rounds as possible before limit, the next arrival, or any process getting
+// down to its last quantum, in one step
+void OnlineRR::skip_rounds(int64_t limit)
+{
+    int64_t n = rq_.size();
+    int64_t min_rem = std::numeric_limits<int64_t>::max();
+    for (int id : rq_) min_rem = std::min(min_rem, rem(id));
+    if (min_rem <= quantum_) return;
+    if (admitted_ < pushed_) limit = std::min(limit, rec(admitted_).arrival_time);
+    // 128-bit: n * quantum can exceed int64 for huge queues and quanta
+    __int128 round = (__int128)n * quantum_;
+    __int128 k = std::min<__int128>((min_rem - 1) / quantum_, (limit - curr_time_) / round);
+    if (k <= 0) return;
+
+    for (int64_t i = 0; i < n; i++) {
+        int id = rq_[i];
+        if (rec(id).start_time == -1) rec(id).start_time = time_add(curr_time_, time_mul(quantum_, i));
+        rem(id) -= quantum_ * (int64_t)k;
+    }
+    if (observer && observer->wants_slices) {
+        ids_.assign(rq_.begin(), rq_.end());
+        observer->on_rounds(ids_.data(), n, curr_time_, quantum_, (int64_t)k);
+    }
+    // each round adds at least one entry unless the queue holds a single
+    // process, so max_seq_len_ rounds are enough to fill seq
+    for (int64_t r = 0; r < k && r < max_seq_len_ && (int64_t)seq_.size() < max_seq_len_; r++)
+        for (int64_t i = 0; i < n; i++) push_seq(rq_[i]);
+    // only unbounded when draining, where the end is the true finish time
+    __int128 skipped = round * k;
+    curr_time_ = skipped <= INT64_MAX - curr_time_
+        ? curr_time_ + (int64_t)skipped
+        : time_overflow("+", curr_time_, (int64_t)std::min<__int128>(skipped, INT64_MAX));
+}
+
+// drops the finished prefix of the records once it makes up at least half
+// of them, so each release costs amortised O(1)
+void OnlineRR::release_finished()
+{
+    while (first_unfinished_ < pushed_ && rec(first_unfinished_).finish_time != -1)
+        first_unfinished_++;
+    int64_t done = first_unfinished_ - base_;
+    if (done < 4096 || done * 2 < (int64_t)procs_.size()) return;
+    procs_.erase(procs_.begin(), procs_.begin() + done);
+    remaining_.erase(remaining_.begin(), remaining_.begin() + done);
+    base_ = first_unfinished_;
+}
+
+void OnlineRR::advance_to(int64_t t)
+{
+    if (t < curr_time_)
+        throw fatal_error() << "cannot go back in time from " << curr_time_ << " to " << t;
+    run(t, false);
+}
+
+void OnlineRR::drain() { run(std::numeric_limits<int64_t>::max(), true); }
+
+int64_t OnlineRR::feed(Generator<Process> & source)
+{
+    int64_t n = 0;
+    for (const Process & p : source) {
+        advance_to(p.arrival_time);
+        push(p.arrival_time, p.burst);
+        n++;
+    }
+    return n;
+}
+
+void OnlineRR::run(int64_t t, bool drain)
+{
+    while (true) {
+        if (running_ < 0) {
+            admit_until(curr_time_, true);
+            if (rq_.empty()) {
+                if (!idle_) {
+                    idle_ = true;
+                    idle_from_ = curr_time_;
+                }
+                if (admitted_ < pushed_ && rec(admitted_).arrival_time <= t) {
+                    curr_time_ = rec(admitted_).arrival_time;
+                    continue;
+                }
+                if (!drain) curr_time_ = t;
+                return;
+            }
+            if (idle_) {
+                if (curr_time_ > idle_from_) push_seq(-1);
+                idle_ = false;
+            }
+            // amortised: the O(queue) check runs once per queue length slices
+            if (++since_skip_check_ >= (int64_t)rq_.size()) {
+                since_skip_check_ = 0;
+                skip_rounds(t);
+            }
+            start_slice();
+        }
+        if (slice_end_ > t) {
+            curr_time_ = t;
+            return;
+        }
+        finish_slice();
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "generator.h"
+#include "scheduler.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/// incremental round-robin simulator: arrivals are pushed as they happen,
+/// simulated time is advanced explicitly, and the state can be queried at
+/// any point
+///
+/// example:
+///   OnlineRR sim(quantum, max_seq_len);
+///   for (each job seen in the log) {
+///       sim.advance_to(job.time);
+///       sim.push(job.time, job.burst);
+///       report(sim.running(), sim.ready_count(), sim.completed());
+///   }
+///   sim.drain();
+///
+/// the results are the same as simulate_rr() on the same processes. Each
+/// pushed arrival, started slice and finished process costs amortised O(1);
+/// full rounds over the ready queue are skipped in one step like in
+/// simulate_rr(), so huge bursts with a small quantum stay cheap
+class OnlineRR {
+public:
+    OnlineRR(int64_t quantum, int64_t max_seq_len);
+
+    /// adds a process arriving at time arrival (>= now() and >= the previous
+    /// arrival) needing burst > 0 units of CPU; returns its id (0, 1, ...)
+    /// throws fatal_error if the arrival is out of order
+    int push(int64_t arrival, int64_t burst);
+
+    /// simulates up to time t (>= now()); a slice still running at t is
+    /// left in progress
+    void advance_to(int64_t t);
+    /// simulates until every pushed process has finished
+    void drain();
+    /// pulls every process from source, advancing to each arrival and
+    /// pushing it; returns the number of processes pulled. Call drain()
+    /// afterwards to run the remaining ones to completion
+    int64_t feed(Generator<Process> & source);
+
+    /// current simulated time
+    int64_t now() const { return curr_time_; }
+    /// id of the process on the CPU at now(), or -1 if the CPU is idle
+    int running() const { return running_; }
+    /// number of processes waiting in the ready queue (not counting the
+    /// running one)
+    int64_t ready_count() const { return rq_.size(); }
+    /// number of pushed processes that have not arrived yet
+    int64_t pending_count() const { return pushed_ - admitted_; }
+    /// number of processes finished so far
+    int64_t completed() const { return completed_; }
+    /// number of processes pushed so far
+    int64_t size() const { return pushed_; }
+
+    /// process records with start/finish times filled in as they happen;
+    /// id must be >= first_retained()
+    const Process & process(int id) const { return procs_[id - base_]; }
+    /// records of processes first_retained(), first_retained() + 1, ...
+    const std::vector<Process> & processes() const { return procs_; }
+    /// id of the oldest process whose record is still kept (0 unless
+    /// retain_finished is off)
+    int64_t first_retained() const { return base_; }
+    /// condensed execution sequence so far (same format as simulate_rr())
+    const std::vector<int> & seq() const { return seq_; }
+
+    /// called with each process as soon as it finishes
+    std::function<void(const Process &)> on_finish;
+    /// receives on_slice()/on_rounds() if its wants_slices is set
+    SimObserver * observer = nullptr;
+    /// when false, records of finished processes are released once every
+    /// earlier process has finished too, so memory stays proportional to
+    /// the processes in flight rather than to all processes ever pushed;
+    /// use on_finish to collect results
+    bool retain_finished = true;
+
+private:
+    int64_t quantum_, max_seq_len_;
+    int64_t curr_time_ = 0;
+    // records and remaining bursts of processes base_, base_ + 1, ...
+    std::vector<Process> procs_;
+    std::vector<int64_t> remaining_;
+    int64_t base_ = 0;
+    // every process before this one has finished
+    int64_t first_unfinished_ = 0;
+    // ready queue; the running process is not in it
+    std::deque<int> rq_;
+    int64_t pushed_ = 0, admitted_ = 0, completed_ = 0;
+    int64_t last_arrival_ = 0;
+    // current slice: running_ runs during [slice_start_, slice_end_), which
+    // is shorter than slice_len_ only if the end saturated at INT64_MAX
+    int running_ = -1;
+    int64_t slice_start_ = 0, slice_end_ = 0, slice_len_ = 0;
+    // the CPU has been idle since idle_from_ (reported as -1 in seq)
+    bool idle_ = true;
+    int64_t idle_from_ = 0;
+    // slices started since the ready queue was last checked for skippable
+    // rounds; the check is O(ready queue) so it is done once per round
+    int64_t since_skip_check_ = 0;
+    std::vector<int> seq_;
+    // scratch copy of the ready queue for observer->on_rounds()
+    std::vector<int> ids_;
+
+    void run(int64_t t, bool drain);
+    void admit_until(int64_t t, bool inclusive);
+    void push_seq(int id);
+    void start_slice();
+    void finish_slice();
+    void skip_rounds(int64_t limit);
+    void release_finished();
+    Process & rec(int64_t id) { return procs_[id - base_]; }
+    int64_t & rem(int64_t id) { return remaining_[id - base_]; }
+};
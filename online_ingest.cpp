@@ -0,0 +1,70 @@
+#include "online_ingest.h"
+#include "common.h"
+
+OnlineIngest::OnlineIngest(OnlineRR & sim, int64_t reorder_window)
+    : sim_(sim), reorder_window_(reorder_window)
+{
+    if (reorder_window < 0) throw fatal_error() << "the reorder window must not be negative";
+}
+
+void OnlineIngest::submit(int64_t arrival, int64_t burst)
+{
+    if (arrival < 0) throw fatal_error() << "arrival must not be negative";
+    if (burst <= 0) throw fatal_error() << "burst must be positive";
+    Arrival a;
+    a.time = arrival;
+    a.burst = burst;
+    queue_.push(a);
+}
+
+int64_t OnlineIngest::watermark() const
+{
+    // newest_ >= -1 and the window >= 0, so this cannot overflow
+    return newest_ - reorder_window_;
+}
+
+// moves the submitted arrivals into the window
+void OnlineIngest::collect()
+{
+    Arrival a;
+    while (queue_.try_pop(a)) {
+        a.order = collected_++;
+        newest_ = std::max(newest_, a.time);
+        window_.push(a);
+    }
+}
+
+void OnlineIngest::admit(const Arrival & a)
+{
+    int64_t t = a.time;
+    if (t < sim_.now()) {
+        t = sim_.now();
+        late_++;
+    }
+    sim_.advance_to(t);
+    sim_.push(t, a.burst);
+}
+
+int64_t OnlineIngest::pump()
+{
+    collect();
+    int64_t mark = watermark();
+    int64_t n = 0;
+    for (; !window_.empty() && window_.top().time <= mark; n++) {
+        admit(window_.top());
+        window_.pop();
+    }
+    if (mark > sim_.now()) sim_.advance_to(mark);
+    return n;
+}
+
+int64_t OnlineIngest::flush()
+{
+    collect();
+    int64_t n = 0;
+    for (; !window_.empty(); n++) {
+        admit(window_.top());
+        window_.pop();
+    }
+    return n;
+}
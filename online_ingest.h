@@ -0,0 +1,77 @@
+#pragma once
+#include "mpsc_queue.h"
+#include "online.h"
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+/// lets any number of threads report arrivals to an OnlineRR that is run by
+/// a single simulation thread
+///
+/// submit() puts the arrival on a lock-free MpscQueue and returns at once,
+/// so reporting threads never wait for the simulation. The simulation
+/// thread calls pump(), which collects the submitted arrivals into a small
+/// reorder window ordered by arrival time (ties in the order they were
+/// collected) and admits them into the engine once no earlier arrival can
+/// still come: arrivals may be reported up to reorder_window time units
+/// later than the newest arrival seen so far. The engine is then advanced
+/// to that point, the watermark.
+///
+/// an arrival reported later than that is admitted at the current
+/// simulated time instead and counted in late()
+///
+/// example:
+///   OnlineRR sim(quantum, max_seq_len);
+///   OnlineIngest ingest(sim, 100);
+///   // on any thread:
+///   ingest.submit(job.time, job.burst);
+///   // on the simulation thread:
+///   while (running) { ingest.pump(); report(sim.running(), sim.completed()); }
+///   ingest.flush();
+///   sim.drain();
+class OnlineIngest {
+public:
+    /// sim is only touched by the thread calling pump()/flush()
+    OnlineIngest(OnlineRR & sim, int64_t reorder_window);
+
+    /// any thread: reports a process arriving at time arrival (>= 0) that
+    /// needs burst > 0 units of CPU; throws fatal_error on bad values
+    void submit(int64_t arrival, int64_t burst);
+
+    /// simulation thread: collects the submitted arrivals, admits those at
+    /// or before the watermark and advances the engine to it; returns the
+    /// number of processes admitted
+    int64_t pump();
+    /// simulation thread: collects and admits everything submitted so far,
+    /// whatever the window, e.g. before sim.drain() at shutdown
+    int64_t flush();
+
+    /// newest arrival time seen minus the window: no arrival at or before it
+    /// is expected any more
+    int64_t watermark() const;
+    /// arrivals collected but waiting in the window
+    int64_t held() const { return window_.size(); }
+    /// arrivals that came after the watermark had passed them
+    int64_t late() const { return late_; }
+
+private:
+    struct Arrival {
+        int64_t time = 0, burst = 0;
+        // order of collection, to break ties
+        uint64_t order = 0;
+        bool operator>(const Arrival & that) const
+        {
+            return time != that.time ? time > that.time : order > that.order;
+        }
+    };
+    OnlineRR & sim_;
+    int64_t reorder_window_;
+    MpscQueue<Arrival> queue_;
+    std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>> window_;
+    int64_t newest_ = -1;
+    uint64_t collected_ = 0;
+    int64_t late_ = 0;
+
+    void collect();
+    void admit(const Arrival & a);
+};
@@ -0,0 +1,135 @@
+#include "perf.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int open_counter(uint32_t type, uint64_t config)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // also count the threads started later, e.g. the pools of the parallel
+    // engine and of the table formatting
+    attr.inherit = 1;
+    // pid = 0, cpu = -1: this thread, on whatever cpu it runs
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+PerfCounters::PerfCounters()
+{
+    static const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[NCOUNTERS] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    };
+    for (int i = 0; i < NCOUNTERS; i++) {
+        fds_[i] = open_counter(events[i].type, events[i].config);
+        if (fds_[i] < 0 && error_.empty() && events[i].type == PERF_TYPE_HARDWARE)
+            error_ = std::string("hardware counters unavailable: ") + strerror(errno);
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (int fd : fds_)
+        if (fd >= 0) close(fd);
+}
+
+bool PerfCounters::available() const
+{
+    for (int fd : fds_)
+        if (fd >= 0) return true;
+    return false;
+}
+
+void PerfCounters::start()
+{
+    for (int fd : fds_) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+PerfSample PerfCounters::stop()
+{
+    int64_t vals[NCOUNTERS];
+    for (int i = 0; i < NCOUNTERS; i++) {
+        vals[i] = -1;
+        if (fds_[i] < 0) continue;
+        ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t v;
+        if (read(fds_[i], &v, sizeof(v)) == sizeof(v)) vals[i] = v;
+    }
+    PerfSample s;
+    s.cycles = vals[CYCLES];
+    s.instructions = vals[INSTRUCTIONS];
+    s.cache_misses = vals[CACHE_MISSES];
+    s.branch_misses = vals[BRANCH_MISSES];
+    s.task_clock_ns = vals[TASK_CLOCK];
+    return s;
+}
+
+double PerfSample::ipc() const
+{
+    if (cycles <= 0 || instructions < 0) return -1;
+    return double(instructions) / cycles;
+}
+
+// prints a counter, or n/a if it is missing
+static void print_count(std::ostream & os, int64_t v)
+{
+    if (v < 0)
+        os << std::setw(14) << "n/a";
+    else
+        os << std::setw(14) << v;
+}
+
+static void print_per_proc(std::ostream & os, int64_t v, int64_t nprocs)
+{
+    if (v < 0 || nprocs <= 0)
+        os << std::setw(10) << "n/a";
+    else
+        os << std::setw(10) << std::fixed << std::setprecision(2) << double(v) / nprocs;
+}
+
+void print_perf(std::ostream & os, const std::string & phase, const PerfSample & s, int64_t nprocs)
+{
+    os << "perf " << std::left << std::setw(10) << phase << std::right << " cycles=";
+    print_count(os, s.cycles);
+    os << " instr=";
+    print_count(os, s.instructions);
+    os << " ipc=";
+    if (s.ipc() < 0)
+        os << std::setw(5) << "n/a";
+    else
+        os << std::setw(5) << std::fixed << std::setprecision(2) << s.ipc();
+    os << " cache-miss=";
+    print_count(os, s.cache_misses);
+    os << " branch-miss=";
+    print_count(os, s.branch_misses);
+    os << " task-clock=" << std::setw(8) << std::fixed << std::setprecision(3)
+       << (s.task_clock_ns < 0 ? 0.0 : s.task_clock_ns * 1e-6) << "ms";
+    os << " | per proc: instr=";
+    print_per_proc(os, s.instructions, nprocs);
+    os << " cache-miss=";
+    print_per_proc(os, s.cache_misses, nprocs);
+    os << " branch-miss=";
+    print_per_proc(os, s.branch_misses, nprocs);
+    os << "\n";
+}
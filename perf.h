@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/// values read from the hardware performance counters for one measured region
+/// counters that could not be opened on this machine are reported as -1
+struct PerfSample {
+    int64_t cycles = -1;
+    int64_t instructions = -1;
+    int64_t cache_misses = -1;
+    int64_t branch_misses = -1;
+    // time the counters were actually running, in nanoseconds (software clock)
+    int64_t task_clock_ns = -1;
+
+    /// instructions per cycle, or -1 if either counter is missing
+    double ipc() const;
+};
+
+/// thin wrapper around Linux perf_event_open(2), counting events of the
+/// calling thread and of the threads it starts after the constructor
+/// (user space only); a thread's counts are added when it exits, so a
+/// measured region sees those of the threads that ran and exited in it
+///
+/// example:
+///   PerfCounters pc;
+///   pc.start();
+///   ... measured code ...
+///   PerfSample s = pc.stop();
+///
+/// counters are opened once in the constructor and reused for every
+/// start()/stop() pair; if the kernel refuses a counter (no PMU in a VM,
+/// perf_event_paranoid too high, ...) it is simply left out
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters & operator=(const PerfCounters &) = delete;
+
+    /// true if at least one counter could be opened
+    bool available() const;
+    /// reason the hardware counters are missing (empty if all opened)
+    const std::string & error() const { return error_; }
+
+    /// resets and enables all counters
+    void start();
+    /// disables all counters and returns their values since start()
+    PerfSample stop();
+
+private:
+    enum { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, TASK_CLOCK, NCOUNTERS };
+    int fds_[NCOUNTERS];
+    std::string error_;
+};
+
+/// prints one line summarizing a sample, normalized by the number of
+/// processes simulated (nprocs <= 0 disables the per-process columns)
+void print_perf(std::ostream & os, const std::string & phase, const PerfSample & s, int64_t nprocs);
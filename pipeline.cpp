@@ -0,0 +1,176 @@
+#include "pipeline.h"
+#include "async_io.h"
+#include "common.h"
+#include "online.h"
+#include "report.h"
+#include "spsc_queue.h"
+#include "time_math.h"
+#include "workload.h"
+
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <thread>
+
+// input is read in blocks of this many bytes, with this many reads in
+// flight, and handed over in chunks of whole lines of about the same size
+static constexpr size_t kChunkBytes = 1 << 20;
+static constexpr unsigned kReadDepth = 4;
+// finished processes are handed over in batches of this many
+static constexpr size_t kBatchProcs = 4096;
+// chunks/batches in flight between two stages
+static constexpr size_t kQueueDepth = 8;
+
+// reader stage: cuts the input into chunks ending at a line break (except
+// possibly the last one)
+static void read_chunks(int fd, bool use_io_uring, SpscQueue<std::string> & out)
+{
+    BlockReader in(fd, kChunkBytes, kReadDepth, use_io_uring);
+    std::string carry, block;
+    while (in.next(block)) {
+        size_t cut = block.rfind('\n');
+        // a line longer than what has been read so far: keep reading
+        if (cut == std::string::npos) {
+            carry += block;
+            continue;
+        }
+        std::string rest(block, cut + 1);
+        block.resize(cut + 1);
+        block.insert(0, carry);
+        carry = std::move(rest);
+        if (!out.push(std::move(block))) return;
+    }
+    if (!carry.empty()) out.push(std::move(carry));
+    out.close();
+}
+
+// formatter stage: processes finish out of order, so each one waits in
+// window (at index id - next) until every earlier one has been formatted
+static void format_rows(
+    SpscQueue<std::vector<Process>> & in, std::string & rows, ArrowResultWriter * arrow)
+{
+    std::deque<Process> window;
+    int64_t next = 0;
+    std::vector<Process> batch;
+    while (in.pop(batch)) {
+        for (const Process & p : batch) {
+            size_t slot = p.id - next;
+            if (slot >= window.size()) window.resize(slot + 1);
+            window[slot] = p;
+        }
+        while (!window.empty() && window.front().id >= 0) {
+            format_proc_row(rows, window.front());
+            if (arrow) arrow->add(window.front());
+            window.pop_front();
+            next++;
+        }
+    }
+}
+
+// parses the plain form of a line, two decimal integers separated and
+// surrounded by whitespace; anything else (blank lines, errors, "+5")
+// returns false and is left to parse_process_line()
+static bool parse_plain_line(const char * p, const char * end, int64_t & arrival, int64_t & burst)
+{
+    p = skip_space(p, end);
+    auto r = std::from_chars(p, end, arrival);
+    if (r.ec != std::errc() || r.ptr == end || !is_space(*r.ptr)) return false;
+    p = skip_space(r.ptr, end);
+    r = std::from_chars(p, end, burst);
+    if (r.ec != std::errc()) return false;
+    return skip_space(r.ptr, end) == end;
+}
+
+PipelineResult simulate_pipelined(
+    int fd, int64_t quantum, int64_t max_seq_len, bool use_io_uring, ArrowResultWriter * arrow)
+{
+    SpscQueue<std::string> chunks(kQueueDepth);
+    SpscQueue<std::vector<Process>> finished(kQueueDepth);
+    PipelineResult res;
+    std::exception_ptr read_error;
+    std::thread reader([&] {
+        try {
+            read_chunks(fd, use_io_uring, chunks);
+        } catch (...) {
+            read_error = std::current_exception();
+            chunks.close();
+        }
+    });
+    std::exception_ptr format_error;
+    std::thread formatter([&] {
+        try {
+            format_rows(finished, res.rows, arrow);
+        } catch (...) {
+            format_error = std::current_exception();
+            finished.close();
+        }
+    });
+    try {
+        OnlineRR sim(quantum, max_seq_len);
+        sim.retain_finished = false;
+        std::vector<Process> batch;
+        sim.on_finish = [&](const Process & p) {
+            batch.push_back(p);
+            if (batch.size() < kBatchProcs) return;
+            finished.push(std::move(batch));
+            batch.clear();
+            batch.reserve(kBatchProcs);
+        };
+
+        std::string chunk;
+        std::vector<Process> one;
+        int64_t line_no = 0;
+        while (chunks.pop(chunk)) {
+            const char * p = chunk.data();
+            const char * end = p + chunk.size();
+            while (p < end) {
+                auto eol = static_cast<const char *>(memchr(p, '\n', end - p));
+                if (!eol) eol = end;
+                line_no++;
+                try {
+                    int64_t arrival, burst;
+                    bool blank = false;
+                    if (!parse_plain_line(p, eol, arrival, burst)) {
+                        one.clear();
+                        blank = !parse_process_line(std::string_view(p, eol - p), one);
+                        if (!blank) {
+                            arrival = one[0].arrival_time;
+                            burst = one[0].burst;
+                        }
+                    }
+                    if (!blank) {
+                        sim.advance_to(arrival);
+                        sim.push(arrival, burst);
+                    }
+                } catch (time_overflow_error &) {
+                    throw;
+                } catch (std::exception & e) {
+                    input_error err;
+                    err.line = line_no;
+                    err << e.what();
+                    throw err;
+                }
+                p = eol + 1;
+            }
+        }
+        sim.drain();
+        if (!batch.empty()) finished.push(std::move(batch));
+        finished.close();
+        res.seq = sim.seq();
+        res.nprocs = sim.size();
+    } catch (...) {
+        // stop the other stages before handing the error over
+        chunks.close();
+        finished.close();
+        reader.join();
+        formatter.join();
+        throw;
+    }
+    reader.join();
+    formatter.join();
+    // a read error ends the input early, so the results are incomplete
+    if (read_error) std::rethrow_exception(read_error);
+    if (format_error) std::rethrow_exception(format_error);
+    return res;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "arrow_writer.h"
+#include "common.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// results of simulate_pipelined()
+struct PipelineResult {
+    int64_t nprocs = 0;
+    // condensed execution sequence, as from simulate_rr()
+    std::vector<int> seq;
+    // rows of the process table in id order, formatted like print_procs()
+    std::string rows;
+};
+
+/// thrown by simulate_pipelined() for a malformed or out-of-order input line
+class input_error : public fatal_error {
+public:
+    int64_t line = 0;
+};
+
+/// simulates the "arrival burst" lines read from the file descriptor fd in
+/// three threads connected by SpscQueues:
+///
+///   reader:     reads fd in big blocks (several at a time with io_uring, see
+///               BlockReader) and hands over chunks of whole lines
+///   simulator:  (the calling thread) parses each chunk and pushes the
+///               arrivals into an OnlineRR as they are parsed
+///   formatter:  takes batches of finished processes and formats their rows,
+///               putting them back in id order; with arrow, it also adds
+///               the rows to the Arrow file, which is written in record
+///               batches as the simulation goes
+///
+/// so reading and formatting overlap with the simulation, and finished
+/// records are released as the simulation goes. The rows cannot be written
+/// out before the sequence, which is only complete at the end, so they are
+/// returned for the caller to print. Arrivals must be non-decreasing
+///
+/// throws input_error for a bad line (with the same messages as
+/// parse_process_line()), and whatever OnlineRR throws otherwise, e.g.
+/// time_overflow_error, or fatal_error if reading fails
+PipelineResult simulate_pipelined(int fd, int64_t quantum, int64_t max_seq_len,
+    bool use_io_uring = true, ArrowResultWriter * arrow = nullptr);
@@ -0,0 +1,46 @@
+#include "progress.h"
+
+#include <algorithm>
+#include <iomanip>
+
+ProgressMonitor::ProgressMonitor(
+    std::ostream & os, int64_t nprocs, double heartbeat_secs, double budget_secs)
+    : os_(os), nprocs_(nprocs), heartbeat_secs_(heartbeat_secs), budget_secs_(budget_secs)
+{
+    next_beat_ = heartbeat_secs_;
+    // start with frequent polls, poll() grows the interval as needed
+    poll_interval = 16;
+}
+
+bool ProgressMonitor::poll(int64_t curr_time, int64_t finished)
+{
+    last_time_ = curr_time;
+    last_finished_ = finished;
+    // only one clock read per poll, the engine already amortises the calls
+    double now = timer_.elapsed();
+    // rescale the poll interval so polls happen about every 5ms, whatever
+    // the cost of one engine iteration is (at most 8x change per poll)
+    double since = now - prev_poll_secs_;
+    prev_poll_secs_ = now;
+    double scale = since > 0 ? 0.005 / since : 8;
+    scale = std::min(8.0, std::max(0.125, scale));
+    poll_interval = std::min<int64_t>(int64_t(1) << 30, std::max<int64_t>(1, poll_interval * scale));
+    if (heartbeat_secs_ > 0 && now >= next_beat_) {
+        double rate = (finished - prev_beat_finished_) / (now - prev_beat_secs_);
+        std::ios_base::fmtflags f = os_.flags();
+        os_ << "progress: " << std::fixed << std::setprecision(1) << now
+            << "s simulated_time=" << curr_time << " finished=" << finished << "/" << nprocs_
+            << " (" << (nprocs_ ? 100.0 * finished / nprocs_ : 100.0) << "%) rate="
+            << std::setprecision(0) << rate << " procs/s\n";
+        os_.flags(f);
+        os_.flush();
+        prev_beat_secs_ = now;
+        prev_beat_finished_ = finished;
+        next_beat_ = now + heartbeat_secs_;
+    }
+    if (budget_secs_ > 0 && now >= budget_secs_) {
+        cancelled_ = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "common.h"
+#include "scheduler.h"
+#include <ostream>
+
+/// SimObserver that prints a heartbeat line every heartbeat_secs seconds
+/// and stops the simulation once budget_secs of wall-clock time are used up
+/// (a value <= 0 disables either feature)
+///
+/// example:
+///   ProgressMonitor mon(std::cerr, processes.size(), 5, 60);
+///   simulate_rr(q, maxs, processes, seq, &mon);
+///   if (mon.cancelled()) ... results are partial ...
+///
+class ProgressMonitor : public SimObserver {
+public:
+    ProgressMonitor(std::ostream & os, int64_t nprocs, double heartbeat_secs, double budget_secs);
+
+    bool poll(int64_t curr_time, int64_t finished) override;
+
+    /// true if the time budget ran out and the simulation was stopped
+    bool cancelled() const { return cancelled_; }
+    /// simulated time and finished count at the last poll
+    int64_t last_time() const { return last_time_; }
+    int64_t last_finished() const { return last_finished_; }
+
+private:
+    std::ostream & os_;
+    int64_t nprocs_;
+    double heartbeat_secs_, budget_secs_;
+    Timer timer_;
+    double next_beat_;
+    double prev_poll_secs_ = 0;
+    double prev_beat_secs_ = 0;
+    int64_t prev_beat_finished_ = 0;
+    int64_t last_time_ = 0, last_finished_ = 0;
+    bool cancelled_ = false;
+};
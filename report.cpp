@@ -0,0 +1,156 @@
+#include "report.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <memory>
+#include <string>
+
+// appends the label of process id, right-aligned in a field of width
+// characters: the id, followed by ":name" if it has a name
+static void append_id(std::string & out, int id, const ProcessNames * names, int width)
+{
+    std::string_view name = names ? names->get(id) : std::string_view();
+    char buf[24];
+    char * end = std::to_chars(buf, buf + sizeof(buf), id).ptr;
+    int len = (end - buf) + (name.empty() ? 0 : 1 + name.size());
+    if (len < width) out.append(width - len, ' ');
+    out.append(buf, end);
+    if (name.empty()) return;
+    out += ':';
+    out += name;
+}
+
+void print_seq(std::ostream & os, const std::vector<int> & seq, const ProcessNames * names)
+{
+    os << "seq = [";
+    bool comma = false;
+    std::string label;
+    for (auto p : seq) {
+        if( comma) os << ","; else comma = true;
+        label.clear();
+        append_id(label, p, names, 0);
+        os << label;
+    }
+    os << "]\n";
+}
+
+// appends v right-aligned in a field of width characters, like std::setw
+static void append_field(std::string & out, int64_t v, int width)
+{
+    char buf[24];
+    char * end = std::to_chars(buf, buf + sizeof(buf), v).ptr;
+    if (end - buf < width) out.append(width - (end - buf), ' ');
+    out.append(buf, end);
+}
+
+int proc_id_width(const std::vector<Process> & procs, const ProcessNames * names)
+{
+    int width = 2;
+    if (!names || names->empty()) return width;
+    std::string label;
+    for (const auto & p : procs) {
+        label.clear();
+        append_id(label, p.id, names, 0);
+        width = std::max<int>(width, label.size());
+    }
+    return width;
+}
+
+void format_proc_row(
+    std::string & out, const Process & p, int indent, const ProcessNames * names, int id_width)
+{
+    out.append(indent, ' ');
+    out += "| ";
+    append_id(out, p.id, names, id_width);
+    out += " | ";
+    append_field(out, p.arrival_time, 20);
+    out += " | ";
+    append_field(out, p.burst, 20);
+    out += " | ";
+    append_field(out, p.start_time, 20);
+    out += " | ";
+    append_field(out, p.finish_time, 20);
+    out += " |\n";
+}
+
+void print_procs(
+    std::ostream & os, const std::vector<Process> & procs, int indent, const ProcessNames * names)
+{
+    int id_width = proc_id_width(procs, names);
+    print_procs_header(os, indent, id_width);
+    std::string row;
+    for (const auto & p : procs) {
+        row.clear();
+        format_proc_row(row, p, indent, names, id_width);
+        os << row;
+    }
+    print_procs_footer(os, indent, id_width);
+}
+
+// rows per chunk formatted by one task of print_procs_parallel(), about
+// 3 MB of text
+static constexpr int64_t kRowsPerChunk = 1 << 15;
+
+void print_procs_parallel(std::ostream & os, const std::vector<Process> & procs, int nthreads,
+    int indent, const ProcessNames * names)
+{
+    int64_t n = procs.size();
+    int64_t nchunks = (n + kRowsPerChunk - 1) / kRowsPerChunk;
+    if (nthreads <= 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+    if (nthreads < 2 || nchunks < 4) return print_procs(os, procs, indent, names);
+
+    // chunk c is formatted into slots[c % depth], so only depth chunks of
+    // text exist at a time; the slot's buffer is reused once written
+    struct Slot {
+        std::string text;
+        std::atomic<int64_t> chunk { -1 };
+    };
+    int64_t depth = std::min<int64_t>(nchunks, 2 * nthreads);
+    std::unique_ptr<Slot[]> slots(new Slot[depth]);
+    int id_width = proc_id_width(procs, names);
+    ThreadPool pool(nthreads);
+    auto format = [&](int64_t c) {
+        Slot & s = slots[c % depth];
+        s.text.clear();
+        for (int64_t i = c * kRowsPerChunk; i < std::min(n, (c + 1) * kRowsPerChunk); i++)
+            format_proc_row(s.text, procs[i], indent, names, id_width);
+        s.chunk.store(c, std::memory_order_release);
+        s.chunk.notify_one();
+    };
+
+    print_procs_header(os, indent, id_width);
+    for (int64_t c = 0; c < depth; c++) pool.submit([&, c] { format(c); });
+    for (int64_t c = 0; c < nchunks; c++) {
+        Slot & s = slots[c % depth];
+        for (int64_t done = s.chunk.load(std::memory_order_acquire); done != c;
+             done = s.chunk.load(std::memory_order_acquire))
+            s.chunk.wait(done);
+        os.write(s.text.data(), s.text.size());
+        if (c + depth < nchunks) pool.submit([&, c] { format(c + depth); });
+    }
+    print_procs_footer(os, indent, id_width);
+}
+
+// the border line; the first segment spans the Id and Arrival columns
+static std::string procs_border(int indent, int id_width)
+{
+    return std::string(indent, ' ') + "+" + std::string(25 + id_width, '-')
+        + "+----------------------+----------------------+----------------------+\n";
+}
+
+void print_procs_header(std::ostream & os, int indent, int id_width)
+{
+    std::string inds(indent, ' ');
+    os << procs_border(indent, id_width) << inds << "| "
+       << std::string(std::max(0, id_width - 2), ' ')
+       << "Id |              Arrival |                Burst |                Start |      "
+          "         Finish |\n"
+       << procs_border(indent, id_width);
+}
+
+void print_procs_footer(std::ostream & os, int indent, int id_width)
+{
+    os << procs_border(indent, id_width);
+}
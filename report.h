@@ -0,0 +1,37 @@
+#pragma once
+#include "scheduler.h"
+#include "workload.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// the functions below print a process that has a name (if names are
+/// given) as "id:name", so names that look like ids or repeat stay
+/// unambiguous
+
+/// prints the execution sequence as "seq = [a,b,c]\n"
+void print_seq(
+    std::ostream & os, const std::vector<int> & seq, const ProcessNames * names = nullptr);
+
+/// prints the table of processes with their arrival, burst, start and
+/// finish times
+void print_procs(std::ostream & os, const std::vector<Process> & procs, int indent = 0,
+    const ProcessNames * names = nullptr);
+
+/// prints the same as print_procs(), but formats the rows on nthreads
+/// threads (<= 0: one per hardware thread): the table is cut into chunks,
+/// each formatted into its own buffer by a worker, and the buffers are
+/// written out in order as they become ready, with a bounded number of
+/// them in memory at a time. Small tables are printed by print_procs()
+void print_procs_parallel(std::ostream & os, const std::vector<Process> & procs, int nthreads,
+    int indent = 0, const ProcessNames * names = nullptr);
+
+/// width of the Id column of the table of procs: 2, or the longest
+/// "id:name" label if there are names
+int proc_id_width(const std::vector<Process> & procs, const ProcessNames * names);
+/// the lines print_procs() prints before and after the rows
+void print_procs_header(std::ostream & os, int indent = 0, int id_width = 2);
+void print_procs_footer(std::ostream & os, int indent = 0, int id_width = 2);
+/// appends the table row of p, exactly as print_procs() prints it
+void format_proc_row(std::string & out, const Process & p, int indent = 0,
+    const ProcessNames * names = nullptr, int id_width = 2);
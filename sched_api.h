@@ -0,0 +1,121 @@
+/* C interface to the round-robin simulator, provided by libscheduler.a and
+ * libscheduler.so
+ *
+ * typical use:
+ *
+ *   sched_ctx * ctx = sched_create();
+ *   sched_load_columns(ctx, n, arrivals, bursts);
+ *   if (sched_run(ctx, quantum, max_seq_len) != SCHED_OK)
+ *       fprintf(stderr, "%s\n", sched_last_error(ctx));
+ *   const int64_t * finish = sched_finish_times(ctx);
+ *   int64_t seq_len;
+ *   const int32_t * seq = sched_seq(ctx, &seq_len);
+ *   sched_free(ctx);
+ *
+ * input columns are not copied: they are read directly from the caller's
+ * arrays, which must stay valid and unchanged until the next
+ * sched_load_columns() or sched_free(). Results are written to the context's
+ * own arrays, or to caller-owned ones registered with sched_set_output().
+ *
+ * a context must not be used from two threads at once; separate contexts
+ * are independent. Many contexts can be run concurrently with sched_submit()
+ * on an executor, which owns a work-stealing pool of threads. No function
+ * throws or aborts, errors are reported by the return value and
+ * sched_last_error().
+ */
+#ifndef SCHED_API_H
+#define SCHED_API_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCHED_API __attribute__((visibility("default")))
+
+/* bumped whenever a function signature or semantics change incompatibly */
+#define SCHED_ABI_VERSION 1
+
+/* return codes */
+#define SCHED_OK 0
+#define SCHED_EINVAL -1   /* bad argument, see sched_last_error() */
+#define SCHED_ENOMEM -2   /* out of memory */
+#define SCHED_EINTERNAL -3 /* unexpected failure inside the engine */
+#define SCHED_EOVERFLOW -4  /* a simulated time does not fit in 64 bits */
+
+typedef struct sched_ctx sched_ctx;
+
+/* ABI version of the library, compare with SCHED_ABI_VERSION */
+SCHED_API int sched_abi_version(void);
+
+/* creates an empty context, returns NULL if out of memory */
+SCHED_API sched_ctx * sched_create(void);
+/* frees the context and everything it owns (NULL is allowed) */
+SCHED_API void sched_free(sched_ctx * ctx);
+
+/* sets the workload: process i arrives at arrivals[i] (non-decreasing,
+ * >= 0) and needs bursts[i] > 0 time units; the arrays are borrowed */
+SCHED_API int sched_load_columns(
+    sched_ctx * ctx, int64_t n, const int64_t * arrivals, const int64_t * bursts);
+
+/* makes sched_run() write start/finish times to caller-owned arrays of at
+ * least n elements instead of the context's own; pass NULLs to go back to
+ * the internal arrays */
+SCHED_API int sched_set_output(sched_ctx * ctx, int64_t * starts, int64_t * finishes);
+
+/* runs the simulation on the loaded workload */
+SCHED_API int sched_run(sched_ctx * ctx, int64_t quantum, int64_t max_seq_len);
+
+/* results of the last sched_run(), valid until the next run/load/free;
+ * entries are -1 for processes that did not start/finish */
+SCHED_API const int64_t * sched_start_times(const sched_ctx * ctx);
+SCHED_API const int64_t * sched_finish_times(const sched_ctx * ctx);
+/* condensed execution sequence (-1 = idle CPU), length stored in *len */
+SCHED_API const int32_t * sched_seq(const sched_ctx * ctx, int64_t * len);
+
+/* process-wide: when a simulated time overflows, sched_run() fails with
+ * SCHED_EOVERFLOW (saturate = 0, the default) or clamps the time to
+ * INT64_MAX and carries on (saturate = 1) */
+SCHED_API void sched_set_overflow_saturate(int saturate);
+
+/* message describing the last error on this context ("" if none) */
+SCHED_API const char * sched_last_error(const sched_ctx * ctx);
+
+/* asynchronous execution
+ *
+ *   sched_executor * ex = sched_executor_create(0);
+ *   for (i = 0; i < k; i++) jobs[i] = sched_submit(ex, ctx[i], q, maxs, NULL, NULL);
+ *   for (i = 0; i < k; i++) { status = sched_job_wait(jobs[i]); sched_job_free(jobs[i]); }
+ *   sched_executor_free(ex);
+ */
+typedef struct sched_executor sched_executor;
+typedef struct sched_job sched_job;
+/* called on a worker thread when a submitted run finishes, with the
+ * return value of sched_run() */
+typedef void (*sched_callback)(sched_ctx * ctx, int status, void * user);
+
+/* creates an executor with nthreads workers (<= 0: one per hardware
+ * thread), returns NULL on failure */
+SCHED_API sched_executor * sched_executor_create(int nthreads);
+/* waits for all submitted jobs, then frees the executor */
+SCHED_API void sched_executor_free(sched_executor * ex);
+
+/* queues sched_run(ctx, quantum, max_seq_len) on the executor and returns
+ * immediately; ctx must not be touched until the job is done. callback may
+ * be NULL. Returns a handle to wait on (free it with sched_job_free), or
+ * NULL if out of memory */
+SCHED_API sched_job * sched_submit(sched_executor * ex, sched_ctx * ctx, int64_t quantum,
+    int64_t max_seq_len, sched_callback callback, void * user);
+/* 1 if the job (including its callback) has finished, 0 otherwise */
+SCHED_API int sched_job_done(const sched_job * job);
+/* blocks until the job has finished, returns its sched_run() status */
+SCHED_API int sched_job_wait(sched_job * job);
+/* releases the handle; the job itself still runs to completion */
+SCHED_API void sched_job_free(sched_job * job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,14 @@
 #include "scheduler.h"
 #include "common.h"
+#include "huge_pages.h"
+#include "thread_pool.h"
+#include "time_math.h"
 #include "iostream"
+#include <atomic>
+#include <exception>
+#include <latch>
+#include <mutex>
+#include <numeric>
 
 // runs Round-Robin scheduling simulator
 // input:
@@ -16,44 +24,158 @@
 //         - adjust finish_time and start_time for each process
 //         - do not adjust other fields
 //
+static std::atomic<OverflowPolicy> g_overflow_policy { OverflowPolicy::Error };
+
+void set_overflow_policy(OverflowPolicy policy) {
+    g_overflow_policy = policy;
+}
+
+OverflowPolicy overflow_policy() {
+    return g_overflow_policy;
+}
+
+int64_t time_overflow(const char * op, int64_t a, int64_t b) {
+    if(g_overflow_policy == OverflowPolicy::Saturate){
+        bool negative = op[0] == '+' ? a < 0 : (a < 0) != (b < 0);
+        return negative ? INT64_MIN : INT64_MAX;
+    }
+    time_overflow_error e;
+    e << "simulated time overflows 64 bits: " << a << " " << op << " " << b;
+    throw e;
+}
+
 void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & processes, std::vector<int> & seq) {
+    if(!simulate_rr_small(quantum, max_seq_len, processes, seq)){
+        simulate_rr(quantum, max_seq_len, processes, seq, nullptr);
+    }
+}
+
+namespace {
+
+// the engine below reads the input and writes the results through a view,
+// so the same code runs on std::vector<Process> and on caller-owned columns
+struct ProcessView {
+    Process * procs;
+    int64_t n;
+    int64_t size() const { return n; }
+    int64_t arrival(int64_t i) const { return procs[i].arrival_time; }
+    int64_t burst(int64_t i) const { return procs[i].burst; }
+    int64_t & start(int64_t i) { return procs[i].start_time; }
+    int64_t & finish(int64_t i) { return procs[i].finish_time; }
+    // processes lo..lo+len-1, as ids 0..len-1
+    ProcessView sub(int64_t lo, int64_t len) const { return { procs + lo, len }; }
+};
+
+struct ColumnView {
+    const int64_t * arrivals;
+    const int64_t * bursts;
+    int64_t * starts;
+    int64_t * finishes;
+    int64_t n;
+    int64_t size() const { return n; }
+    int64_t arrival(int64_t i) const { return arrivals[i]; }
+    int64_t burst(int64_t i) const { return bursts[i]; }
+    int64_t & start(int64_t i) { return starts[i]; }
+    int64_t & finish(int64_t i) { return finishes[i]; }
+    ColumnView sub(int64_t lo, int64_t len) const { return { arrivals + lo, bursts + lo, starts + lo, finishes + lo, len }; }
+};
+
+}
+
+// first index i >= lo of w whose process arrives after t (inclusive) or at
+// or after t (otherwise); arrivals are sorted, so this gallops forward from
+// lo and then bisects, costing O(log k) for a run of k arrivals
+template <class View>
+static int64_t arrivals_end(View & w, int64_t lo, int64_t t, bool inclusive) {
+    auto arrived = [&](int64_t i) { return inclusive ? w.arrival(i) <= t : w.arrival(i) < t; };
+    int64_t n = w.size();
+    if(lo >= n || !arrived(lo)){
+        return lo;
+    }
+    //arrived(lo) holds; find hi past the run
+    int64_t hi = lo + 1, step = 1;
+    while(hi < n && arrived(hi)){
+        lo = hi;
+        step *= 2;
+        hi = lo + step;
+    }
+    hi = std::min(hi, n);
+    while(hi - lo > 1){
+        int64_t mid = lo + (hi - lo) / 2;
+        if(arrived(mid)){
+            lo = mid;
+        }
+        else{
+            hi = mid;
+        }
+    }
+    return hi;
+}
+
+// the simulation itself, on any of the views above; with kSkip = false
+// full rounds are never skipped, which saves scanning the ready queue for
+// workloads where skipping rarely applies
+template <class View, bool kSkip = true>
+static void rr_engine(int64_t quantum, int64_t max_seq_len, View & w, std::vector<int> & seq, SimObserver * observer) {
 
     seq.clear();
     int64_t curr_time = 0;
-    std::vector<int> rq, jq;
+    int64_t finished = 0;
+    int64_t countdown = observer ? observer->poll_interval : 0;
+    bool slices = observer && observer->wants_slices;
+    std::vector<int> rq;
     std::vector<int64_t> remaining_bursts;
+    //The job queue is w[next..n): processes are taken from it in arrival order.
+    int64_t n_procs = w.size(), next = 0;
 
-    for(auto &process : processes){
-        jq.push_back(process.id);
-        remaining_bursts.push_back(process.burst);
+    //Both can hold every process, so they get huge pages on big inputs;
+    //the ready queue only touches the pages it grows into.
+    reserve_huge(rq, n_procs);
+    reserve_huge(remaining_bursts, n_procs);
+    for(int64_t i = 0; i < n_procs; i++){
+        remaining_bursts.push_back(w.burst(i));
     }
 
+    //Moves all processes arriving before curr_time (or at curr_time, if
+    //inclusive) from the job queue to the back of the ready queue at once.
+    auto admit = [&](bool inclusive) {
+        int64_t end = arrivals_end(w, next, curr_time, inclusive);
+        if(end > next){
+            rq.resize(rq.size() + (end - next));
+            std::iota(rq.end() - (end - next), rq.end(), (int)next);
+            next = end;
+        }
+    };
+
     while(true){
 
+        //Amortised check for progress reporting / cancellation.
+        if(observer && --countdown <= 0){
+            countdown = observer->poll_interval;
+            if(!observer->poll(curr_time, finished)){
+                break;
+            }
+        }
+
         //All processes completed and there are no additional processes to start, end the simulation.
-        if(rq.empty() && jq.empty()){
+        if(rq.empty() && next == n_procs){
             break;
         }
 
         //No processes in progress and there are additional processes to start.
-        if(rq.empty() && !jq.empty()){
-            rq.push_back(jq.at(0));
-            jq.erase(jq.begin());
-            curr_time = processes.at(rq.at(0)).arrival_time;
-            if((int64_t)seq.size() < max_seq_len && curr_time == 0){
-                seq.push_back(rq.at(0));
-            }
-            else{
-                seq.push_back(-1);
+        if(rq.empty() && next < n_procs){
+            curr_time = w.arrival(next);
+            admit(true);
+            if((int64_t)seq.size() < max_seq_len){
+                seq.push_back(curr_time == 0 ? rq.at(0) : -1);
             }
         }
 
         //Processes in progress and there are additional processes to start.
-        if(!rq.empty() && !jq.empty()){
-            //Process arriving at curr_time
-            if(processes.at(jq.at(0)).arrival_time == curr_time){
-                rq.push_back(jq.at(0));
-                jq.erase(jq.begin());
+        if(!rq.empty() && next < n_procs){
+            //Processes arriving at curr_time
+            if(w.arrival(next) == curr_time){
+                admit(true);
                 continue;
             }
 
@@ -61,9 +183,9 @@ void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & pr
             //if they all have more than one quantum unit of time in remaining_bursts,
             //before next process from the job queue arrives, and before any of the current
             //processes in progress finish.
-            bool flag = true;
+            bool flag = kSkip;
             int64_t min_bursts = remaining_bursts.at(rq.at(0));
-            for(int i = 0; i < (int)rq.size(); i++){
+            for(int i = 0; flag && i < (int)rq.size(); i++){
                 if(remaining_bursts.at(rq.at(i)) <= quantum){
                     flag = false;
                     break;
@@ -77,17 +199,21 @@ void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & pr
             if(min_bursts%quantum == 0){
                 n--;
             }
-            int64_t m = (processes.at(jq.at(0)).arrival_time - curr_time)/((int)rq.size()*quantum);
-            if((curr_time + (int)rq.size()*quantum) < processes.at(jq.at(0)).arrival_time){
+            int64_t round = time_mul(rq.size(), quantum);
+            int64_t m = (w.arrival(next) - curr_time)/round;
+            if(time_add(curr_time, round) < w.arrival(next)){
                 if(flag){
                     int64_t k = std::min(n, m);
                     for(int i = 0; i < (int)rq.size(); i++){
-                        if(processes.at(rq.at(i)).start_time == -1){
-                            processes.at(rq.at(i)).start_time = curr_time+quantum*i;
+                        if(w.start(rq.at(i)) == -1){
+                            w.start(rq.at(i)) = time_add(curr_time, time_mul(quantum, i));
                         }
                         remaining_bursts.at(rq.at(i)) -= quantum*k;
                     }
-                    curr_time += (int)rq.size()*quantum*k;
+                    if(slices){
+                        observer->on_rounds(rq.data(), (int)rq.size(), curr_time, quantum, k);
+                    }
+                    curr_time = time_add(curr_time, time_mul(round, k));
                     for(int64_t i = 0; i < k && i < max_seq_len; i++){
                         for(int j = 0; j < (int)rq.size(); j++){
                             if((int64_t)seq.size() < max_seq_len && seq.back() != rq.at(j)){
@@ -103,67 +229,64 @@ void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & pr
             //a process(es) in the ready-queue that has less than one quantum unit of
             //time, incremeant curr_time by one quantum at a time.
             if(remaining_bursts.at(rq.at(0)) > quantum){
-                if(processes.at(rq.at(0)).start_time == -1){
-                    processes.at(rq.at(0)).start_time = curr_time;
+                if(w.start(rq.at(0)) == -1){
+                    w.start(rq.at(0)) = curr_time;
+                }
+                if(slices){
+                    observer->on_slice(rq.at(0), curr_time, curr_time + quantum);
                 }
-                curr_time += quantum;
+                curr_time = time_add(curr_time, quantum);
                 if((int64_t)seq.size() < max_seq_len && seq.back() != rq.at(0)){
                     seq.push_back(rq.at(0));
                 }
                 remaining_bursts.at(rq.at(0)) -= quantum;
                 
-                while(!jq.empty() && processes.at(jq.at(0)).arrival_time < curr_time){
-                    rq.push_back(jq.at(0));
-                    jq.erase(jq.begin());
-                }
-                
-                if(!jq.empty() && processes.at(jq.at(0)).arrival_time == curr_time){
-                    rq.push_back(rq.at(0));
-                    rq.erase(rq.begin());
-                    rq.push_back(jq.at(0));
-                    jq.erase(jq.begin());
-                }
-                else{
-                    rq.push_back(rq.at(0));
-                    rq.erase(rq.begin());
-                }
+                admit(false);
+                rq.push_back(rq.at(0));
+                rq.erase(rq.begin());
+                admit(true);
                 continue;
             }
 
             //Process currently in progress has less than or equal to one quantum time unit left to completion,
             //incremeant curr_time by the remaining_burst of the process in progress.
             if(remaining_bursts.at(rq.at(0)) <= quantum){
-                if(processes.at(rq.at(0)).start_time == -1){
-                    processes.at(rq.at(0)).start_time = curr_time;
+                if(w.start(rq.at(0)) == -1){
+                    w.start(rq.at(0)) = curr_time;
+                }
+                if(slices){
+                    observer->on_slice(rq.at(0), curr_time, curr_time + remaining_bursts.at(rq.at(0)));
                 }
-                curr_time += remaining_bursts.at(rq.at(0));
+                curr_time = time_add(curr_time, remaining_bursts.at(rq.at(0)));
                 if((int64_t)seq.size() < max_seq_len && seq.back() != rq.at(0)){
                     seq.push_back(rq.at(0));
                 }
                 remaining_bursts.at(rq.at(0)) = 0;
-                processes.at(rq.at(0)).finish_time = curr_time;
+                w.finish(rq.at(0)) = curr_time;
+                finished++;
                 rq.erase(rq.begin());
-                if(processes.at(jq.at(0)).arrival_time <= curr_time){
-                    rq.push_back(jq.at(0));
-                    jq.erase(jq.begin());
-                }
+                admit(true);
                 continue;
             }
         }
 
         //Processes in progress and there are no additional processes to start.
-        if(!rq.empty() && jq.empty()){
+        if(!rq.empty() && next == n_procs){
 
             //When only one job remains to be completed, finish the process, and end the simulation.
             if(rq.size() == 1){
-                if(processes.at(rq.at(0)).start_time == -1){
-                    processes.at(rq.at(0)).start_time = curr_time;
+                if(w.start(rq.at(0)) == -1){
+                    w.start(rq.at(0)) = curr_time;
+                }
+                if(slices){
+                    observer->on_slice(rq.at(0), curr_time, curr_time + remaining_bursts.at(rq.at(0)));
                 }
-                curr_time += remaining_bursts.at(rq.at(0));
+                curr_time = time_add(curr_time, remaining_bursts.at(rq.at(0)));
                 if((int64_t)seq.size() < max_seq_len && seq.back() != rq.at(0)){
                     seq.push_back(rq.at(0));
                 }
-                processes.at(rq.at(0)).finish_time = curr_time;
+                w.finish(rq.at(0)) = curr_time;
+                finished++;
                 remaining_bursts.at(rq.at(0)) = 0;
                 rq.erase(rq.begin());
                 break;
@@ -172,9 +295,9 @@ void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & pr
             //Determine how many quantums can be safely skipped for every process in progress
             //if they all have more than one quantum unit of time in remaining_bursts,
             //before any of the current processes in progress finish.
-            bool flag = true;
+            bool flag = kSkip;
             int64_t min_bursts = remaining_bursts.at(rq.at(0));
-            for(int i = 0; i < (int)rq.size(); i++){
+            for(int i = 0; flag && i < (int)rq.size(); i++){
                 if(remaining_bursts.at(rq.at(i)) <= quantum){
                     flag = false;
                     break;
@@ -191,12 +314,15 @@ void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & pr
             }
             if(flag){
                 for(int i = 0; i < (int)rq.size(); i++){
-                    if(processes.at(rq.at(i)).start_time == -1){
-                        processes.at(rq.at(i)).start_time = curr_time+quantum*i;
+                    if(w.start(rq.at(i)) == -1){
+                        w.start(rq.at(i)) = time_add(curr_time, time_mul(quantum, i));
                     }
                     remaining_bursts.at(rq.at(i)) -= quantum*n;
                 }
-                curr_time += (int)rq.size()*quantum*n;
+                if(slices){
+                    observer->on_rounds(rq.data(), (int)rq.size(), curr_time, quantum, n);
+                }
+                curr_time = time_add(curr_time, time_mul(time_mul(rq.size(), quantum), n));
                 for(int64_t i = 0; i < n && i < max_seq_len; i++){
                     for(int j = 0; j < (int)rq.size(); j++){
                         if((int64_t)seq.size() < max_seq_len && seq.back() != rq.at(j)){
@@ -209,10 +335,13 @@ void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & pr
             //There is a process(es) in the ready-queue that has less than one quantum unit of
             //time, incremeant curr_time by one quantum at a time.
             if(remaining_bursts.at(rq.at(0)) > quantum){
-                if(processes.at(rq.at(0)).start_time == -1){
-                    processes.at(rq.at(0)).start_time = curr_time;
+                if(w.start(rq.at(0)) == -1){
+                    w.start(rq.at(0)) = curr_time;
                 }
-                curr_time += quantum;
+                if(slices){
+                    observer->on_slice(rq.at(0), curr_time, curr_time + quantum);
+                }
+                curr_time = time_add(curr_time, quantum);
                 if((int64_t)seq.size() < max_seq_len && seq.back() != rq.at(0)){
                     seq.push_back(rq.at(0));
                 }
@@ -225,19 +354,294 @@ void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & pr
             //Process currently in progress has less than or equal to one quantum time unit left to completion,
             //incremeant curr_time by the remaining_burst of the process in progress.
             if(remaining_bursts.at(rq.at(0)) <= quantum){
-                if(processes.at(rq.at(0)).start_time == -1){
-                    processes.at(rq.at(0)).start_time = curr_time;
+                if(w.start(rq.at(0)) == -1){
+                    w.start(rq.at(0)) = curr_time;
                 }        
-                curr_time += remaining_bursts.at(rq.at(0));
+                if(slices){
+                    observer->on_slice(rq.at(0), curr_time, curr_time + remaining_bursts.at(rq.at(0)));
+                }
+                curr_time = time_add(curr_time, remaining_bursts.at(rq.at(0)));
                 if((int64_t)seq.size() < max_seq_len && seq.back() != rq.at(0)){
                     seq.push_back(rq.at(0));
                 }
                 remaining_bursts.at(rq.at(0)) = 0;
-                processes.at(rq.at(0)).finish_time = curr_time;  
+                w.finish(rq.at(0)) = curr_time;
+                finished++;  
                 rq.erase(rq.begin());
                 continue;
             }       
         }     
     }
     return;
-}
\ No newline at end of file
+}
+
+static const int kSmallMaxProcs = 64;
+
+// rr_engine() for at most kSmallMaxProcs processes, with all of its state in
+// fixed-size arrays on the stack: the ready queue is a ring of process
+// indices with a rotating head, and a bit mask marks the queued (or
+// running) processes that are down to their last quantum, so whether full
+// rounds can be skipped is known without scanning the queue. Returns false
+// without doing anything if the input is too large or not sorted by
+// arrival, which the engine relies on
+template <class View>
+static bool rr_small(int64_t quantum, int64_t max_seq_len, View & w, std::vector<int> & seq) {
+    if(w.size() > kSmallMaxProcs){
+        return false;
+    }
+    int n = w.size();
+    for(int i = 0; i < n; i++){
+        if(w.burst(i) <= 0 || w.arrival(i) < (i == 0 ? 0 : w.arrival(i - 1))){
+            return false;
+        }
+    }
+
+    int64_t remaining_bursts[kSmallMaxProcs];
+    uint8_t ring[kSmallMaxProcs];
+    int head = 0, count = 0, next = 0;
+    uint64_t last_quantum = 0;
+    int64_t curr_time = 0;
+    seq.clear();
+
+    auto push_seq = [&](int id) {
+        if((int64_t)seq.size() < max_seq_len && (seq.empty() || seq.back() != id)){
+            seq.push_back(id);
+        }
+    };
+    auto enqueue = [&](int id) {
+        ring[(head + count++) % kSmallMaxProcs] = id;
+    };
+    // queues the processes arriving before curr_time, or at curr_time too
+    auto admit = [&](bool inclusive) {
+        while(next < n && (w.arrival(next) < curr_time || (inclusive && w.arrival(next) == curr_time))){
+            remaining_bursts[next] = w.burst(next);
+            if(remaining_bursts[next] <= quantum){
+                last_quantum |= uint64_t(1) << next;
+            }
+            enqueue(next++);
+        }
+    };
+
+    while(true){
+        admit(true);
+
+        //Nothing to run: the CPU idles until the next arrival, or we are done.
+        if(count == 0){
+            if(next == n){
+                break;
+            }
+            curr_time = w.arrival(next);
+            push_seq(-1);
+            continue;
+        }
+
+        //Every queued process needs more than one quantum and at least one full
+        //round fits before the next arrival: skip as many rounds as possible.
+        if(last_quantum == 0 && (next == n || w.arrival(next) - curr_time >= time_mul(count, quantum))){
+            int64_t min_bursts = remaining_bursts[ring[head]];
+            for(int j = 1; j < count; j++){
+                min_bursts = std::min(min_bursts, remaining_bursts[ring[(head + j) % kSmallMaxProcs]]);
+            }
+            int64_t k = (min_bursts - 1) / quantum;
+            if(next < n){
+                k = std::min(k, (w.arrival(next) - curr_time) / (count * quantum));
+            }
+            for(int j = 0; j < count; j++){
+                int id = ring[(head + j) % kSmallMaxProcs];
+                if(w.start(id) == -1){
+                    w.start(id) = time_add(curr_time, time_mul(quantum, j));
+                }
+                remaining_bursts[id] -= quantum * k;
+                if(remaining_bursts[id] <= quantum){
+                    last_quantum |= uint64_t(1) << id;
+                }
+            }
+            for(int64_t r = 0; r < k && r < max_seq_len && (int64_t)seq.size() < max_seq_len; r++){
+                for(int j = 0; j < count; j++){
+                    push_seq(ring[(head + j) % kSmallMaxProcs]);
+                }
+            }
+            curr_time = time_add(curr_time, time_mul(time_mul(count, quantum), k));
+            continue;
+        }
+
+        //Run the process at the head of the queue for one slice; a preempted
+        //process goes back behind the ones that arrived during the slice, but
+        //ahead of those arriving exactly when it ends.
+        int p = ring[head];
+        head = (head + 1) % kSmallMaxProcs;
+        count--;
+        if(w.start(p) == -1){
+            w.start(p) = curr_time;
+        }
+        push_seq(p);
+        int64_t slice = std::min(quantum, remaining_bursts[p]);
+        curr_time = time_add(curr_time, slice);
+        remaining_bursts[p] -= slice;
+        admit(false);
+        if(remaining_bursts[p] == 0){
+            w.finish(p) = curr_time;
+            last_quantum &= ~(uint64_t(1) << p);
+        }
+        else{
+            if(remaining_bursts[p] <= quantum){
+                last_quantum |= uint64_t(1) << p;
+            }
+            enqueue(p);
+        }
+    }
+    return true;
+}
+
+// simulate_rr() that polls observer (if not null) every observer->poll_interval
+// iterations of the main loop, and stops early if it returns false
+void simulate_rr(int64_t quantum, int64_t max_seq_len, std::vector<Process> & processes, std::vector<int> & seq, SimObserver * observer) {
+    ProcessView w { processes.data(), (int64_t)processes.size() };
+    rr_engine(quantum, max_seq_len, w, seq, observer);
+}
+
+// simulate_rr() on caller-owned columns, see scheduler.h
+void simulate_rr_columns(int64_t quantum, int64_t max_seq_len, int64_t n, const int64_t * arrivals, const int64_t * bursts, int64_t * starts, int64_t * finishes, std::vector<int> & seq, SimObserver * observer) {
+    ColumnView w { arrivals, bursts, starts, finishes, n };
+    for(int64_t i = 0; i < n; i++){
+        starts[i] = finishes[i] = -1;
+    }
+    if(!observer && rr_small(quantum, max_seq_len, w, seq)){
+        return;
+    }
+    rr_engine(quantum, max_seq_len, w, seq, observer);
+}
+
+namespace {
+
+// end of the CPU's busy time after a range of processes, as a function of
+// the time x until which it was busy before the range:
+// f(x) = max(x + add, floor). Composing the functions of two adjacent ranges
+// gives another one of this form, so the ends can be computed with a
+// parallel prefix scan
+struct BusyEnd {
+    int64_t add, floor;
+    int64_t operator()(int64_t x) const { return std::max(time_add(x, add), floor); }
+    // f followed by g
+    BusyEnd then(BusyEnd g) const { return { time_add(add, g.add), std::max(time_add(floor, g.add), g.floor) }; }
+};
+
+// below this many processes per chunk the threads cost more than they save
+const int64_t kMinParallelChunk = 1 << 14;
+
+// runs body(0) .. body(n-1) on pool and waits for all of them; the first
+// exception thrown by a body (e.g. time_overflow_error) is rethrown here,
+// since letting it escape a worker would terminate the program
+template <class F>
+void parallel_for(ThreadPool & pool, int64_t n, F body) {
+    std::latch done(n);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    for(int64_t i = 0; i < n; i++){
+        pool.submit([&, i] {
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!error){
+                    error = std::current_exception();
+                }
+            }
+            done.count_down();
+        });
+    }
+    done.wait();
+    if(error){
+        std::rethrow_exception(error);
+    }
+}
+
+}
+
+// the CPU is idle right before process i iff it arrives after all earlier
+// processes have finished, whatever the scheduling policy. The input is cut
+// at such points into pieces of about equal size, which are independent
+// simulations: each one is run by rr_engine on its own, and their sequences
+// (which start with the -1 of the idle gap) are concatenated
+template <class View>
+static void rr_parallel(int64_t quantum, int64_t max_seq_len, View & w, std::vector<int> & seq, int nthreads) {
+    int64_t n = w.size();
+    ThreadPool pool(nthreads);
+    int64_t nchunks = std::min<int64_t>(pool.size() * 4, n / kMinParallelChunk);
+    if(nchunks < 2){
+        rr_engine(quantum, max_seq_len, w, seq, nullptr);
+        return;
+    }
+    auto chunk_lo = [&](int64_t c) { return n * c / nchunks; };
+
+    // scan 1: the busy-end function of each chunk
+    std::vector<BusyEnd> f(nchunks);
+    parallel_for(pool, nchunks, [&](int64_t c) {
+        BusyEnd acc { 0, -1 };
+        for(int64_t i = chunk_lo(c); i < chunk_lo(c + 1); i++){
+            acc = acc.then({ w.burst(i), time_add(w.arrival(i), w.burst(i)) });
+        }
+        f[c] = acc;
+    });
+    // scan 2: the first idle point of each chunk, given the busy end before
+    // it (-1 before the first process, so that it always starts a piece)
+    std::vector<int64_t> ends(nchunks), cuts(nchunks + 1, n);
+    for(int64_t c = 0, end = -1; c < nchunks; c++){
+        ends[c] = end;
+        end = f[c](end);
+    }
+    parallel_for(pool, nchunks, [&](int64_t c) {
+        int64_t end = ends[c];
+        for(int64_t i = chunk_lo(c); i < chunk_lo(c + 1); i++){
+            if(w.arrival(i) > end){
+                cuts[c] = i;
+                return;
+            }
+            end = time_add(std::max(end, w.arrival(i)), w.burst(i));
+        }
+    });
+    // chunks without an idle point are merged into the piece before them
+    for(int64_t c = nchunks - 1; c >= 0; c--){
+        cuts[c] = std::min(cuts[c], cuts[c + 1]);
+    }
+
+    // each piece's queues and sequence are allocated and first touched by
+    // the worker that simulates it, so they sit on that worker's NUMA node
+    std::vector<std::vector<int>> seqs(nchunks);
+    parallel_for(pool, nchunks, [&](int64_t c) {
+        int64_t lo = cuts[c], hi = cuts[c + 1];
+        if(lo == hi){
+            return;
+        }
+        View piece = w.sub(lo, hi - lo);
+        rr_engine(quantum, max_seq_len, piece, seqs[c], nullptr);
+        for(int & id : seqs[c]){
+            if(id >= 0){
+                id += lo;
+            }
+        }
+    });
+    seq.clear();
+    for(int64_t c = 0; c < nchunks && (int64_t)seq.size() < max_seq_len; c++){
+        int64_t k = std::min<int64_t>(seqs[c].size(), max_seq_len - seq.size());
+        seq.insert(seq.end(), seqs[c].begin(), seqs[c].begin() + k);
+    }
+}
+
+// simulate_rr() on the stack for tiny inputs, see scheduler.h
+bool simulate_rr_small(int64_t quantum, int64_t max_seq_len, std::vector<Process> & processes, std::vector<int> & seq) {
+    ProcessView w { processes.data(), (int64_t)processes.size() };
+    return rr_small(quantum, max_seq_len, w, seq);
+}
+
+// simulate_rr() without skipping rounds, see scheduler.h
+void simulate_rr_stepping(int64_t quantum, int64_t max_seq_len, std::vector<Process> & processes, std::vector<int> & seq, SimObserver * observer) {
+    ProcessView w { processes.data(), (int64_t)processes.size() };
+    rr_engine<ProcessView, false>(quantum, max_seq_len, w, seq, observer);
+}
+
+// simulate_rr() split over nthreads threads, see scheduler.h
+void simulate_rr_parallel(int64_t quantum, int64_t max_seq_len, std::vector<Process> & processes, std::vector<int> & seq, int nthreads) {
+    ProcessView w { processes.data(), (int64_t)processes.size() };
+    rr_parallel(quantum, max_seq_len, w, seq, nthreads);
+}
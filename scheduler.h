@@ -25,9 +25,106 @@ struct Process {
     int64_t finish_time = -1;
 };
 
+// optional hook into a running simulation, for progress reporting,
+// cancellation of long runs and exporting the schedule
+//
+// the engine calls poll() once every poll_interval iterations of its main
+// loop, so the cost when nothing needs to happen is one decrement and
+// compare per iteration; slice callbacks are only made if wants_slices is set
+struct SimObserver {
+    virtual ~SimObserver() {}
+    // curr_time = current simulated time, finished = processes completed
+    // so far; return false to stop the simulation (processes that did not
+    // finish are left with finish_time = -1)
+    virtual bool poll(int64_t, int64_t) { return true; }
+    // process id ran on the CPU during [start, end)
+    virtual void on_slice(int id, int64_t start, int64_t end) { (void)id, (void)start, (void)end; }
+    // the engine skipped `rounds` full round-robin rounds starting at time
+    // start: in each round ids[0..n) ran for quantum each, in that order;
+    // the default expands this into on_slice() calls
+    virtual void on_rounds(const int * ids, int n, int64_t start, int64_t quantum, int64_t rounds)
+    {
+        for (int64_t r = 0; r < rounds; r++)
+            for (int i = 0; i < n; i++, start += quantum) on_slice(ids[i], start, start + quantum);
+    }
+    // number of main loop iterations between poll() calls
+    int64_t poll_interval = 1 << 14;
+    // whether on_slice()/on_rounds() should be called
+    bool wants_slices = false;
+};
+
+// what the engines do when a simulated time, or an intermediate product
+// like quantum * ready queue length, does not fit in int64_t
+enum class OverflowPolicy {
+    // throw time_overflow_error (a fatal_error, see time_math.h); the default
+    Error,
+    // clamp to INT64_MAX and carry on: the affected start/finish times read
+    // as INT64_MAX
+    Saturate,
+};
+
+// process-wide setting used by all engines
+void set_overflow_policy(OverflowPolicy policy);
+OverflowPolicy overflow_policy();
+
 // this is the function you need to implement in scheduler.cpp
 void simulate_rr(
     int64_t quantum,
     int64_t max_seq_len,
     std::vector<Process> & processes,
-    std::vector<int> & seq);
\ No newline at end of file
+    std::vector<int> & seq);
+
+// same as above, reporting to observer (may be nullptr) while running
+void simulate_rr(
+    int64_t quantum,
+    int64_t max_seq_len,
+    std::vector<Process> & processes,
+    std::vector<int> & seq,
+    SimObserver * observer);
+
+// same as simulate_rr(), but on caller-owned columns instead of Process
+// records, without copying them: process i arrives at arrivals[i] and runs
+// for bursts[i]; its start and finish times are written to starts[i] and
+// finishes[i] (-1 if it did not run/finish); process ids are 0..n-1
+void simulate_rr_columns(
+    int64_t quantum,
+    int64_t max_seq_len,
+    int64_t n,
+    const int64_t * arrivals,
+    const int64_t * bursts,
+    int64_t * starts,
+    int64_t * finishes,
+    std::vector<int> & seq,
+    SimObserver * observer);
+
+// same as simulate_rr() for inputs of at most 64 processes sorted by
+// arrival, with all state in fixed-size arrays on the stack, so it does not
+// allocate unless seq has to grow; returns false without touching anything
+// for other inputs. simulate_rr() without an observer, and
+// simulate_rr_columns() with none, try it first
+bool simulate_rr_small(
+    int64_t quantum,
+    int64_t max_seq_len,
+    std::vector<Process> & processes,
+    std::vector<int> & seq);
+
+// same as simulate_rr(), but simulates every time slice instead of skipping
+// runs of full rounds; faster when bursts rarely exceed one quantum, since
+// the ready queue is then never scanned for rounds to skip
+void simulate_rr_stepping(
+    int64_t quantum,
+    int64_t max_seq_len,
+    std::vector<Process> & processes,
+    std::vector<int> & seq,
+    SimObserver * observer);
+
+// same results as simulate_rr(), computed on nthreads threads (<= 0: one per
+// hardware thread) for large inputs: the input is split where the CPU goes
+// idle, and the independent parts are simulated concurrently. Inputs without
+// idle gaps, or too small to be worth splitting, run on the calling thread
+void simulate_rr_parallel(
+    int64_t quantum,
+    int64_t max_seq_len,
+    std::vector<Process> & processes,
+    std::vector<int> & seq,
+    int nthreads);
@@ -0,0 +1,349 @@
+#include "server.h"
+#include "common.h"
+#include "report.h"
+#include "scheduler.h"
+#include "thread_pool.h"
+#include "workload.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <set>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t g_stop = 0;
+
+// open connections, shut down for reading when the server stops so that
+// workers finish their current request and return
+static std::mutex g_conns_mutex;
+static std::set<int> g_conns;
+
+static void on_signal(int) { g_stop = 1; }
+
+// buffered reader over a connected socket
+class SocketReader {
+public:
+    explicit SocketReader(int fd) : fd_(fd) { buf_.resize(1 << 16); }
+
+    // reads a line without the trailing '\n'; returns false on EOF/error
+    bool readline(std::string & line)
+    {
+        line.clear();
+        while (true) {
+            for (size_t i = pos_; i < end_; i++) {
+                if (buf_[i] == '\n') {
+                    line.append(&buf_[pos_], i - pos_);
+                    pos_ = i + 1;
+                    return true;
+                }
+            }
+            line.append(&buf_[pos_], end_ - pos_);
+            pos_ = end_ = 0;
+            if (!fill()) return false;
+        }
+    }
+
+    // whether input past what was read so far is already buffered
+    bool buffered() const { return pos_ < end_; }
+
+    // reads exactly n bytes into dst; returns false on EOF/error
+    bool read(char * dst, size_t n)
+    {
+        while (n > 0) {
+            if (pos_ == end_ && !fill()) return false;
+            size_t k = std::min(n, end_ - pos_);
+            memcpy(dst, &buf_[pos_], k);
+            pos_ += k;
+            dst += k;
+            n -= k;
+        }
+        return true;
+    }
+
+private:
+    int fd_;
+    std::vector<char> buf_;
+    size_t pos_ = 0, end_ = 0;
+
+    bool fill()
+    {
+        if (pos_ == end_) pos_ = end_ = 0;
+        while (true) {
+            ssize_t r = ::read(fd_, &buf_[end_], buf_.size() - end_);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) return false;
+            end_ += r;
+            return true;
+        }
+    }
+};
+
+static bool write_all(int fd, const char * p, size_t n)
+{
+    while (n > 0) {
+        ssize_t r = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+// per-worker buffers, reused across requests and connections so a warm
+// worker does not allocate for workloads no bigger than earlier ones
+struct Workspace {
+    std::vector<Process> processes;
+    std::vector<int> seq;
+    std::vector<int64_t> records;
+    std::string header, line;
+    std::ostringstream out;
+};
+
+// largest BIN request accepted, 1 GiB of records, so a bad count cannot
+// make the server allocate without bound
+static constexpr int64_t kMaxBinRecords = int64_t(1) << 26;
+
+// seconds a client may take to send the rest of a request it has started
+static constexpr int kRequestTimeoutSecs = 30;
+
+// the line ending a RUN workload, with or without a '\r' before the '\n'
+static bool is_end_line(const std::string & line) { return line == "END" || line == "END\r"; }
+
+// parse_int64() with an error message naming the request field
+static int64_t parse_field(std::string_view tok, const char * what)
+{
+    try {
+        return parse_int64(tok);
+    } catch (std::exception &) {
+        throw fatal_error() << what << " must be an integer";
+    }
+}
+
+// reads the workload of one request into ws.processes
+static void read_request(SocketReader & in, const std::string_view * toks, Workspace & ws)
+{
+    ws.processes.clear();
+    if (toks[0] == "RUN") {
+        int line_no = 0;
+        while (true) {
+            if (!in.readline(ws.line)) throw fatal_error() << "unexpected end of input";
+            line_no++;
+            if (is_end_line(ws.line)) break;
+            try {
+                parse_process_line(ws.line, ws.processes);
+            } catch (std::exception & e) {
+                // keep reading up to END so the connection stays usable
+                while (in.readline(ws.line) && !is_end_line(ws.line)) {}
+                throw fatal_error() << "line " << line_no << ": " << e.what();
+            }
+        }
+    } else {
+        int64_t n = parse_field(toks[3], "record count");
+        if (n < 0 || n > kMaxBinRecords)
+            throw fatal_error() << "bad record count, must be 0.." << kMaxBinRecords;
+        ws.records.resize(2 * n);
+        if (!in.read((char *)ws.records.data(), n * 16))
+            throw fatal_error() << "unexpected end of input";
+        ws.processes.resize(n);
+        for (int64_t i = 0; i < n; i++) {
+            Process & p = ws.processes[i];
+            p = Process();
+            p.id = i;
+            p.arrival_time = ws.records[2 * i];
+            p.burst = ws.records[2 * i + 1];
+        }
+    }
+}
+
+// the checks sched_load_columns() makes, so a bad workload gets an error
+// reply instead of meaningless results
+static void check_workload(const std::vector<Process> & procs)
+{
+    for (size_t i = 0; i < procs.size(); i++) {
+        const Process & p = procs[i];
+        bool ordered = i == 0 || p.arrival_time >= procs[i - 1].arrival_time;
+        if (p.arrival_time < 0 || p.burst <= 0 || !ordered)
+            throw fatal_error() << "process " << i << " has a negative arrival, non-positive "
+                                << "burst or arrives out of order";
+    }
+}
+
+// a client connection; its reader keeps what was received past the
+// current request, so the connection can move between workers
+struct Connection {
+    int fd;
+    SocketReader in;
+    explicit Connection(int fd) : fd(fd), in(fd) {}
+};
+
+static void close_connection(Connection * c)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_conns_mutex);
+        g_conns.erase(c->fd);
+    }
+    close(c->fd);
+    delete c;
+}
+
+// serves the requests of c that have arrived, until no more input is
+// buffered; returns false if the connection is to be closed
+static bool serve_requests(Connection & c)
+{
+    thread_local Workspace ws;
+    SocketReader & in = c.in;
+    std::string & header = ws.header;
+    do {
+        if (!in.readline(header)) return false;
+        std::string_view toks[4];
+        size_t ntoks = split_into(header, toks, 4);
+        if (ntoks == 0) continue;
+        std::string reply;
+        bool fatal = false;
+        // whether the whole request has been read, so an error leaves the
+        // stream in sync
+        bool in_sync = false;
+        if (toks[0] == "QUIT") return false;
+        if (toks[0] == "PING") {
+            reply = "PONG\n";
+        } else if ((toks[0] == "RUN" && ntoks == 3) || (toks[0] == "BIN" && ntoks == 4)) {
+            try {
+                // the workload is read first, so a bad header still
+                // consumes it and the next reply answers the next request
+                read_request(in, toks, ws);
+                in_sync = true;
+                int64_t quantum = parse_field(toks[1], "quantum");
+                int64_t max_seq_len = parse_field(toks[2], "max_seq_len");
+                check_workload(ws.processes);
+                if (quantum <= 0) throw fatal_error() << "quantum must be positive";
+                simulate_rr(quantum, max_seq_len, ws.processes, ws.seq);
+                ws.out.str("");
+                print_seq(ws.out, ws.seq);
+                print_procs(ws.out, ws.processes);
+                std::string body = ws.out.str();
+                reply = "OK " + std::to_string(body.size()) + "\n" + body;
+            } catch (std::exception & e) {
+                reply = std::string("ERR ") + e.what() + "\n";
+                // a broken binary payload leaves the stream out of sync
+                fatal = toks[0] == "BIN" && !in_sync;
+            }
+        } else {
+            reply = "ERR unknown request: " + header + "\n";
+        }
+        if (!write_all(c.fd, reply.data(), reply.size()) || fatal) return false;
+    } while (in.buffered());
+    return true;
+}
+
+int run_server(const std::string & path, int nthreads)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cout << "Socket path too long: " << path << "\n";
+        return -1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) {
+        std::cout << "socket: " << strerror(errno) << "\n";
+        return -1;
+    }
+    unlink(path.c_str());
+    if (bind(lfd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(lfd, 128) < 0) {
+        std::cout << "Cannot listen on " << path << ": " << strerror(errno) << "\n";
+        close(lfd);
+        return -1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    // idle connections are polled here, and each one with input is handed
+    // to a worker, which gives it back through returned (waking up the poll
+    // through the pipe) once it has no buffered requests left; so a client
+    // only holds a worker while a request is being served
+    int wake[2];
+    if (pipe2(wake, O_CLOEXEC | O_NONBLOCK) < 0) {
+        std::cout << "pipe: " << strerror(errno) << "\n";
+        close(lfd);
+        return -1;
+    }
+    std::vector<std::unique_ptr<Connection>> idle;
+    std::mutex returned_mutex;
+    std::vector<Connection *> returned;
+    auto take_returned = [&] {
+        std::lock_guard<std::mutex> lock(returned_mutex);
+        for (Connection * c : returned) idle.emplace_back(c);
+        returned.clear();
+    };
+    {
+        ThreadPool pool(nthreads);
+        std::cout << "Listening on " << path << " with " << pool.size() << " worker threads\n";
+        std::cout.flush();
+        std::vector<pollfd> pfds;
+        while (!g_stop) {
+            pfds.clear();
+            pfds.push_back({ lfd, POLLIN, 0 });
+            pfds.push_back({ wake[0], POLLIN, 0 });
+            for (auto & c : idle) pfds.push_back({ c->fd, POLLIN, 0 });
+            // wake up periodically to notice signals
+            int r = poll(pfds.data(), pfds.size(), 200);
+            if (r <= 0) continue;
+            // backwards, so erasing from idle keeps the indices valid
+            for (size_t i = pfds.size(); i-- > 2;) {
+                if (!pfds[i].revents) continue;
+                Connection * c = idle[i - 2].release();
+                idle.erase(idle.begin() + (i - 2));
+                pool.submit([c, &returned_mutex, &returned, &wake] {
+                    if (!serve_requests(*c)) return close_connection(c);
+                    std::lock_guard<std::mutex> lock(returned_mutex);
+                    returned.push_back(c);
+                    // a full pipe already has a wakeup pending
+                    if (write(wake[1], "", 1) < 0) {}
+                });
+            }
+            if (pfds[1].revents) {
+                char buf[64];
+                while (read(wake[0], buf, sizeof(buf)) > 0) {}
+                take_returned();
+            }
+            if (!(pfds[0].revents & POLLIN)) continue;
+            int cfd = accept(lfd, nullptr, nullptr);
+            if (cfd < 0) continue;
+            // a client that stalls in the middle of a request is dropped
+            // rather than holding its worker
+            timeval timeout = { kRequestTimeoutSecs, 0 };
+            setsockopt(cfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            {
+                std::lock_guard<std::mutex> lock(g_conns_mutex);
+                g_conns.insert(cfd);
+            }
+            idle.emplace_back(new Connection(cfd));
+        }
+        // shut down the listening side first, so no new clients queue up
+        // while the pool drains the requests in progress
+        close(lfd);
+        unlink(path.c_str());
+        std::lock_guard<std::mutex> lock(g_conns_mutex);
+        for (int fd : g_conns) shutdown(fd, SHUT_RD);
+    }
+    take_returned();
+    for (auto & c : idle) close_connection(c.release());
+    close(wake[0]);
+    close(wake[1]);
+    std::cout << "Server stopped\n";
+    return 0;
+}
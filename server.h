@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+
+/// runs the simulation server on a Unix domain socket at path until
+/// SIGINT/SIGTERM; requests are served by a pool of nthreads workers
+/// (<= 0 means one per hardware thread) that keep their buffers warm
+/// between requests. Idle connections wait in poll() on the calling thread,
+/// so a connection only holds a worker while its requests are served; a
+/// client that stops for 30 seconds in the middle of a request is dropped
+///
+/// protocol, one or more requests per connection:
+///
+///   RUN quantum max_seq_len\n           text workload, same format as stdin,
+///   arrival burst\n                     terminated by a line "END"
+///   ...
+///   END\n
+///
+///   BIN quantum max_seq_len n\n         binary workload: n records of two
+///   <16*n bytes>                        little-endian int64 (arrival, burst),
+///                                       n <= 2^26
+///
+///   PING\n                              replies "PONG\n"
+///   QUIT\n                              closes the connection
+///
+/// replies to RUN/BIN are "OK <nbytes>\n" followed by nbytes of the usual
+/// "seq = [...]" line and process table, or "ERR <message>\n"
+int run_server(const std::string & path, int nthreads);
@@ -0,0 +1,75 @@
+// reference producer for "scheduler --shm NAME": creates the shared-memory
+// ring NAME and pushes arrivals into it, either the "arrival burst" lines
+// of stdin or synthetic ones, then waits for the consumer to read them all
+//
+//   ./shm_producer /sched-in < trace.txt &
+//   ./scheduler --shm /sched-in 3 100
+
+#include "common.h"
+#include "shm_ring.h"
+#include "workload.h"
+
+#include <iostream>
+
+using VS = std::vector<std::string>;
+
+static int usage(const std::string & pname)
+{
+    std::cout << "Usage:\n"
+              << "    " << pname << " [options] NAME\n"
+              << "Options:\n"
+              << "    --capacity N     ring size in records (default 65536)\n"
+              << "    --timeout S      give up if no consumer attaches within S seconds\n"
+              << "                     (default 60, 0 = wait forever)\n"
+              << "    --generate SPEC  push synthetic arrivals instead of stdin, e.g.\n"
+              << "                     n=1000000,gap=exp:5,burst=uniform:1:50,seed=7\n";
+    return -1;
+}
+
+static int cppmain(const VS & args)
+{
+    uint64_t capacity = 1 << 16;
+    double timeout = 60;
+    std::string spec, name;
+    try {
+        for (size_t i = 1; i < args.size(); i++) {
+            if (args[i] == "--capacity" && i + 1 < args.size())
+                capacity = std::stoull(args[++i]);
+            else if (args[i] == "--timeout" && i + 1 < args.size())
+                timeout = std::stod(args[++i]);
+            else if (args[i] == "--generate" && i + 1 < args.size())
+                spec = args[++i];
+            else if (name.empty() && args[i].compare(0, 2, "--") != 0)
+                name = args[i];
+            else
+                return usage(args[0]);
+        }
+    } catch (...) {
+        return usage(args[0]);
+    }
+    if (name.empty()) return usage(args[0]);
+
+    try {
+        Generator<Process> source
+            = spec.empty() ? replay_arrivals(std::cin) : synthetic_arrivals(SyntheticSpec::parse(spec));
+        auto ring = ShmRing::create(name, capacity);
+        ring->attach_timeout = timeout;
+        int64_t n = 0;
+        for (const Process & p : source) {
+            ring->push({ p.arrival_time, p.burst });
+            n++;
+        }
+        ring->close();
+        ring->wait_drained();
+        std::cerr << "pushed " << n << " arrivals\n";
+    } catch (std::exception & e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    return cppmain({ argv + 0, argv + argc });
+}
@@ -0,0 +1,134 @@
+#include "shm_ring.h"
+#include "common.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+static std::string shm_name(const std::string & name)
+{
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+std::unique_ptr<ShmRing> ShmRing::create(const std::string & name, uint64_t capacity)
+{
+    uint64_t n = 1;
+    while (n < capacity) n *= 2;
+    std::string path = shm_name(name);
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) throw fatal_error() << "shm_open " << path << ": " << strerror(errno);
+    std::unique_ptr<ShmRing> ring(new ShmRing);
+    ring->unlink_name_ = path;
+    ring->map_size_ = sizeof(Header) + n * sizeof(ShmRecord);
+    void * p = MAP_FAILED;
+    if (ftruncate(fd, ring->map_size_) == 0)
+        p = mmap(nullptr, ring->map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    ::close(fd);
+    if (p == MAP_FAILED) throw fatal_error() << "mapping " << path << ": " << strerror(err);
+    ring->hdr_ = new (p) Header;
+    ring->recs_ = reinterpret_cast<ShmRecord *>(ring->hdr_ + 1);
+    ring->mask_ = n - 1;
+    Header & h = *ring->hdr_;
+    h.version = kVersion;
+    h.record_size = sizeof(ShmRecord);
+    h.capacity = n;
+    h.producer_pid = getpid();
+    h.consumer_pid.store(0, std::memory_order_relaxed);
+    ring->created_ns_ = Timer::now_ns();
+    h.head.store(0, std::memory_order_relaxed);
+    h.tail.store(0, std::memory_order_relaxed);
+    h.closed.store(0, std::memory_order_relaxed);
+    // written last: a consumer attaching early sees no ring rather than a
+    // half-initialised one
+    std::atomic_ref<uint64_t>(h.magic).store(kMagic, std::memory_order_release);
+    return ring;
+}
+
+std::unique_ptr<ShmRing> ShmRing::attach(const std::string & name)
+{
+    std::string path = shm_name(name);
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) throw fatal_error() << "shm_open " << path << ": " << strerror(errno);
+    struct stat st;
+    std::unique_ptr<ShmRing> ring(new ShmRing);
+    void * p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header)) {
+        ring->map_size_ = st.st_size;
+        p = mmap(nullptr, ring->map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) throw fatal_error() << path << " is not a ring buffer";
+    ring->hdr_ = static_cast<Header *>(p);
+    const Header & h = *ring->hdr_;
+    if (std::atomic_ref<uint64_t>(ring->hdr_->magic).load(std::memory_order_acquire) != kMagic
+        || h.version != kVersion || h.record_size != sizeof(ShmRecord) || h.capacity == 0
+        || (h.capacity & (h.capacity - 1)) != 0
+        || ring->map_size_ < sizeof(Header) + h.capacity * sizeof(ShmRecord))
+        throw fatal_error() << path << " is not a ring buffer of version " << kVersion;
+    // a consumer that died can be replaced, a live one cannot
+    int64_t other = ring->hdr_->consumer_pid.load(std::memory_order_acquire);
+    if (other != 0 && !(kill(other, 0) != 0 && errno == ESRCH))
+        throw fatal_error() << path << " already has a consumer (pid " << other << ")";
+    ring->hdr_->consumer_pid.store(getpid(), std::memory_order_release);
+    ring->recs_ = reinterpret_cast<ShmRecord *>(ring->hdr_ + 1);
+    ring->mask_ = h.capacity - 1;
+    return ring;
+}
+
+ShmRing::~ShmRing()
+{
+    if (hdr_) munmap(hdr_, map_size_);
+    if (!unlink_name_.empty()) shm_unlink(unlink_name_.c_str());
+}
+
+void ShmRing::wait_drained()
+{
+    uint64_t t = hdr_->tail.load(std::memory_order_relaxed);
+    for (int spins = 0; hdr_->head.load(std::memory_order_acquire) != t; spins++)
+        wait_for_consumer(spins);
+}
+
+void ShmRing::wait_for_producer(int spins)
+{
+    // only checked once waiting has turned into sleeping
+    if (spins >= 1024 && spins % 256 == 0 && kill(hdr_->producer_pid, 0) != 0 && errno == ESRCH)
+        throw fatal_error() << "the producer (pid " << hdr_->producer_pid
+                            << ") exited without closing the ring";
+    backoff(spins);
+}
+
+void ShmRing::wait_for_consumer(int spins)
+{
+    // only checked once waiting has turned into sleeping
+    if (spins >= 1024 && spins % 256 == 0) {
+        int64_t pid = hdr_->consumer_pid.load(std::memory_order_acquire);
+        if (pid == 0 && attach_timeout > 0 && Timer::now_ns() - created_ns_ > attach_timeout * 1e9)
+            throw fatal_error() << "no consumer attached to the ring within " << attach_timeout
+                                << " seconds";
+        if (pid != 0 && kill(pid, 0) != 0 && errno == ESRCH)
+            throw fatal_error() << "the consumer (pid " << pid << ") exited before draining the ring";
+    }
+    backoff(spins);
+}
+
+void ShmRing::backoff(int spins)
+{
+    if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    } else if (spins < 1024) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// one arrival in a ShmRing, in the host's byte order
+struct ShmRecord {
+    int64_t arrival_time;
+    int64_t burst;
+};
+
+/// single-producer single-consumer ring of ShmRecords in POSIX shared
+/// memory, for feeding arrivals from another process on the same host
+/// without pipes or text parsing
+///
+/// the producer creates the ring and pushes records; the consumer attaches
+/// by name and reads the records in place, straight from the shared pages.
+/// Like SpscQueue, each side writes only its own index, so no locks or
+/// read-modify-write operations cross the process boundary. The producer
+/// ends the stream with close(); if it dies without closing, the consumer
+/// notices (by its pid) instead of waiting forever. Likewise a producer
+/// waiting for room or for the ring to drain gives up if the consumer dies
+/// or none attaches within attach_timeout seconds
+///
+/// producer:
+///   auto ring = ShmRing::create("/sched-in", 1 << 16);
+///   for (...) ring->push({ arrival, burst });
+///   ring->close();
+///
+/// consumer:
+///   auto ring = ShmRing::attach("/sched-in");
+///   while (ring->consume([&](const ShmRecord & r) { use(r); })) {}
+class ShmRing {
+public:
+    /// layout of the shared memory: this header, then the records
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t record_size;
+        // number of records, a power of two
+        uint64_t capacity;
+        int64_t producer_pid;
+        // set by the consumer when it attaches, 0 before
+        std::atomic<int64_t> consumer_pid;
+        // next record to read, written by the consumer
+        alignas(64) std::atomic<uint64_t> head;
+        // next record to write, written by the producer
+        alignas(64) std::atomic<uint64_t> tail;
+        alignas(64) std::atomic<uint32_t> closed;
+    };
+    static constexpr uint64_t kMagic = 0x474e495252484353; // "SCHRRING"
+    static constexpr uint32_t kVersion = 2;
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the indices are shared between processes");
+
+    /// creates a ring for capacity records (rounded up to a power of two)
+    /// under name ("/name", the leading slash is added if missing),
+    /// replacing a stale one; the name is removed again when the ring is
+    /// destroyed. Throws fatal_error on failure
+    static std::unique_ptr<ShmRing> create(const std::string & name, uint64_t capacity);
+    /// attaches to the ring created under name as its consumer; throws
+    /// fatal_error if there is none, it is not a ring of this version or
+    /// another live process is already attached
+    static std::unique_ptr<ShmRing> attach(const std::string & name);
+    ~ShmRing();
+    ShmRing(const ShmRing &) = delete;
+    ShmRing & operator=(const ShmRing &) = delete;
+
+    /// producer: seconds push() and wait_drained() wait for a consumer to
+    /// attach, counted from create(), before throwing fatal_error (<= 0:
+    /// wait forever)
+    double attach_timeout = 60;
+
+    /// producer: appends r, waiting while the ring is full; throws
+    /// fatal_error if the consumer is gone (see attach_timeout)
+    void push(const ShmRecord & r)
+    {
+        uint64_t t = hdr_->tail.load(std::memory_order_relaxed);
+        for (int spins = 0; t - head_cache_ == mask_ + 1; spins++) {
+            head_cache_ = hdr_->head.load(std::memory_order_acquire);
+            if (t - head_cache_ == mask_ + 1) wait_for_consumer(spins);
+        }
+        recs_[t & mask_] = r;
+        hdr_->tail.store(t + 1, std::memory_order_release);
+    }
+    /// producer: ends the stream; the consumer still gets every record
+    /// pushed before
+    void close() { hdr_->closed.store(1, std::memory_order_release); }
+    /// producer: waits until the consumer has read every record; throws
+    /// fatal_error like push()
+    void wait_drained();
+
+    /// consumer: waits for records and calls f on each available one (at
+    /// most a quarter of the ring, so the producer can carry on meanwhile),
+    /// in place; returns false once the ring is closed and empty. Throws
+    /// fatal_error if the producer died without closing the ring
+    template <class F>
+    bool consume(F && f)
+    {
+        uint64_t h = hdr_->head.load(std::memory_order_relaxed);
+        for (int spins = 0;; spins++) {
+            uint64_t t = hdr_->tail.load(std::memory_order_acquire);
+            if (t != h) {
+                uint64_t end = std::min(t, h + (mask_ + 1) / 4 + 1);
+                for (uint64_t i = h; i != end; i++) f(static_cast<const ShmRecord &>(recs_[i & mask_]));
+                hdr_->head.store(end, std::memory_order_release);
+                return true;
+            }
+            // records pushed before the close are visible after it
+            if (hdr_->closed.load(std::memory_order_acquire)) {
+                if (hdr_->tail.load(std::memory_order_acquire) != h) continue;
+                return false;
+            }
+            wait_for_producer(spins);
+        }
+    }
+
+private:
+    Header * hdr_ = nullptr;
+    ShmRecord * recs_ = nullptr;
+    uint64_t mask_ = 0;
+    size_t map_size_ = 0;
+    // the creator removes the name when done
+    std::string unlink_name_;
+    // producer's copy of hdr_->head
+    uint64_t head_cache_ = 0;
+    // when the producer created the ring, for attach_timeout
+    int64_t created_ns_ = 0;
+
+    ShmRing() = default;
+    void wait_for_producer(int spins);
+    void wait_for_consumer(int spins);
+    static void backoff(int spins);
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// bounded single-producer single-consumer queue
+///
+/// lock-free: one thread pushes and another pops; each side writes only its
+/// own index and reads the other's, so a transfer costs an atomic load and
+/// store on each side and no read-modify-write. Each side also caches the
+/// last seen value of the other's index and re-reads it only when the queue
+/// looks full (or empty), so the two cache lines rarely move between cores.
+///
+/// the blocking push()/pop() spin briefly, then yield, then sleep, which
+/// suits handing over big items (chunks of input, batches of results)
+/// rather than a stream of single values
+///
+/// close() ends the stream and may be called by either side, e.g. by the
+/// consumer to stop the producer after an error: push() then fails, and
+/// pop() fails once the items pushed before the close have been popped
+///
+/// example:
+///   SpscQueue<std::string> q(8);
+///   std::thread producer([&] { while (...) q.push(read_chunk()); q.close(); });
+///   std::string chunk;
+///   while (q.pop(chunk)) use(chunk);
+///   producer.join();
+template <class T>
+class SpscQueue {
+public:
+    /// capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t n = 1;
+        while (n < capacity) n *= 2;
+        slots_.resize(n);
+        mask_ = n - 1;
+    }
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue & operator=(const SpscQueue &) = delete;
+
+    /// producer: moves item into the queue unless it is full
+    bool try_push(T & item)
+    {
+        size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_cache_ == slots_.size()) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t - head_cache_ == slots_.size()) return false;
+        }
+        slots_[t & mask_] = std::move(item);
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    /// producer: waits for room and pushes item; returns false (dropping
+    /// item) if the queue is closed
+    bool push(T item)
+    {
+        for (int spins = 0; !closed_.load(std::memory_order_acquire); spins++) {
+            if (try_push(item)) return true;
+            backoff(spins);
+        }
+        return false;
+    }
+
+    /// consumer: moves the oldest item out unless the queue is empty
+    bool try_pop(T & item)
+    {
+        size_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h == tail_cache_) return false;
+        }
+        item = std::move(slots_[h & mask_]);
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    /// consumer: waits for an item; returns false once the queue is closed
+    /// and empty
+    bool pop(T & item)
+    {
+        for (int spins = 0;; spins++) {
+            if (try_pop(item)) return true;
+            // everything pushed before the close is visible after it
+            if (closed_.load(std::memory_order_acquire)) return try_pop(item);
+            backoff(spins);
+        }
+    }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    // next slot to pop, written by the consumer, and its copy of tail_
+    alignas(64) std::atomic<size_t> head_ { 0 };
+    size_t tail_cache_ = 0;
+    // next slot to push, written by the producer, and its copy of head_
+    alignas(64) std::atomic<size_t> tail_ { 0 };
+    size_t head_cache_ = 0;
+    alignas(64) std::atomic<bool> closed_ { false };
+
+    static void backoff(int spins)
+    {
+        if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else if (spins < 1024) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+};
@@ -0,0 +1,73 @@
+#include "thread_pool.h"
+
+// the pool and worker index of the calling thread, if it is a worker
+static thread_local ThreadPool * tl_pool = nullptr;
+static thread_local int tl_index = -1;
+
+ThreadPool::ThreadPool(int nthreads)
+{
+    if (nthreads <= 0) nthreads = std::thread::hardware_concurrency();
+    if (nthreads <= 0) nthreads = 1;
+    for (int i = 0; i < nthreads; i++) queues_.emplace_back(new Queue);
+    for (int i = 0; i < nthreads; i++) workers_.emplace_back([this, i] { worker(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto & t : workers_) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    int q = tl_pool == this ? tl_index : next_queue_.fetch_add(1) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1);
+    // taking the lock orders this notify after a worker's predicate check
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    cv_.notify_one();
+}
+
+// pops from the back of our own deque, or steals from the front of another
+bool ThreadPool::take(int self, std::function<void()> & task)
+{
+    int n = queues_.size();
+    for (int k = 0; k < n; k++) {
+        Queue & q = *queues_[(self + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        if (k == 0) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        pending_.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::worker(int self)
+{
+    tl_pool = this;
+    tl_index = self;
+    while (true) {
+        std::function<void()> task;
+        if (take(self, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        cv_.wait(lock, [this] { return stopping_ || pending_.load() > 0; });
+        if (stopping_ && pending_.load() == 0) return;
+    }
+}
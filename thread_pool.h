@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// fixed-size work-stealing pool of worker threads
+///
+/// every worker owns a deque of tasks: tasks submitted from outside the pool
+/// are spread over the deques round-robin, tasks submitted by a worker go
+/// to its own deque. A worker runs its own tasks newest first and, when it
+/// runs out, steals the oldest task of another worker, so one long task
+/// never holds up the tasks queued behind it.
+///
+/// the threads are started once and stay alive (with their thread_local
+/// buffers) until the pool is destroyed; the destructor finishes all
+/// queued tasks before joining
+class ThreadPool {
+public:
+    /// nthreads <= 0 means one thread per hardware thread
+    explicit ThreadPool(int nthreads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /// queues task for execution on one of the workers
+    void submit(std::function<void()> task);
+    /// number of worker threads
+    int size() const { return workers_.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    // tasks queued but not yet taken by a worker
+    std::atomic<int64_t> pending_ { 0 };
+    std::atomic<unsigned> next_queue_ { 0 };
+    std::mutex sleep_mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+
+    bool take(int self, std::function<void()> & task);
+    void worker(int self);
+};
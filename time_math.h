@@ -0,0 +1,33 @@
+#pragma once
+#include "common.h"
+#include "scheduler.h"
+#include <cstdint>
+
+/// thrown by the engines when a simulated time overflows int64_t and the
+/// policy is OverflowPolicy::Error
+class time_overflow_error : public fatal_error {};
+
+/// applies overflow_policy() to an overflowing operation: throws
+/// time_overflow_error, or returns INT64_MAX to saturate
+[[gnu::cold, gnu::noinline]] int64_t time_overflow(const char * op, int64_t a, int64_t b);
+
+/// checked arithmetic on simulated times
+///
+/// the common case compiles to the plain add/multiply and a never-taken
+/// branch on the overflow flag; all the handling is out of line in
+/// time_overflow()
+inline int64_t time_add(int64_t a, int64_t b)
+{
+    int64_t r;
+    if (__builtin_add_overflow(a, b, &r)) [[unlikely]]
+        return time_overflow("+", a, b);
+    return r;
+}
+
+inline int64_t time_mul(int64_t a, int64_t b)
+{
+    int64_t r;
+    if (__builtin_mul_overflow(a, b, &r)) [[unlikely]]
+        return time_overflow("*", a, b);
+    return r;
+}
@@ -0,0 +1,113 @@
+#include "trace.h"
+#include "common.h"
+#include "time_math.h"
+
+#include <cinttypes>
+
+ChromeTraceWriter::ChromeTraceWriter(
+    const std::string & path, int64_t nprocs, int64_t max_rounds, SimObserver * next)
+    : path_(path), named_(nprocs, false), max_rounds_(max_rounds), next_(next)
+{
+    f_ = fopen(path.c_str(), "w");
+    if (!f_) throw fatal_error() << "cannot open trace file " << path;
+    buf_.resize(1 << 20);
+    setvbuf(f_, buf_.data(), _IOFBF, buf_.size());
+    wants_slices = true;
+    poll_interval = next_ ? next_->poll_interval : int64_t(1) << 62;
+    fputs("{\"traceEvents\":[\n", f_);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"simulate_rr\"}}", f_);
+    first_ = false;
+    thread_name(0, "CPU 0");
+}
+
+ChromeTraceWriter::~ChromeTraceWriter()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void ChromeTraceWriter::close()
+{
+    if (!f_) return;
+    fputs("\n]}\n", f_);
+    bool ok = !ferror(f_);
+    ok = fclose(f_) == 0 && ok;
+    f_ = nullptr;
+    if (!ok) throw fatal_error() << "error writing trace file " << path_;
+}
+
+bool ChromeTraceWriter::poll(int64_t curr_time, int64_t finished)
+{
+    if (!next_) return true;
+    bool result = next_->poll(curr_time, finished);
+    poll_interval = next_->poll_interval;
+    return result;
+}
+
+void ChromeTraceWriter::thread_name(int tid, const char * name)
+{
+    fprintf(f_,
+        "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+        first_ ? "" : ",\n", tid, name);
+    // keep the CPU track first and processes in id order
+    fprintf(f_,
+        ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+        tid, tid);
+    first_ = false;
+}
+
+// process tracks are named the first time the process runs
+void ChromeTraceWriter::process_track(int id)
+{
+    if (id < 0 || id >= (int)named_.size() || named_[id]) return;
+    named_[id] = true;
+    char name[32];
+    snprintf(name, sizeof(name), "P%d", id);
+    thread_name(id + 1, name);
+}
+
+void ChromeTraceWriter::event(const char * name, int id, int tid, int64_t start, int64_t dur)
+{
+    fprintf(f_,
+        ",\n{\"name\":\"%s%d\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%" PRId64
+        ",\"dur\":%" PRId64 "}",
+        name, id, tid, start, dur);
+}
+
+void ChromeTraceWriter::on_slice(int id, int64_t start, int64_t end)
+{
+    process_track(id);
+    event("P", id, 0, start, end - start);
+    event("P", id, id + 1, start, end - start);
+    written_++;
+}
+
+void ChromeTraceWriter::on_rounds(
+    const int * ids, int n, int64_t start, int64_t quantum, int64_t rounds)
+{
+    int64_t detailed = rounds < max_rounds_ ? rounds : max_rounds_;
+    SimObserver::on_rounds(ids, n, start, quantum, detailed);
+    if (detailed == rounds) return;
+
+    // downsample the rest of the batch: one slice on the CPU track covering
+    // all remaining rounds, and one per process covering its share
+    int64_t rest = rounds - detailed;
+    int64_t round_len = time_mul(n, quantum);
+    int64_t t0 = time_add(start, time_mul(detailed, round_len));
+    int64_t t1 = time_add(t0, time_mul(rest, round_len));
+    fprintf(f_,
+        ",\n{\"name\":\"RR x%" PRId64 " rounds\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%" PRId64
+        ",\"dur\":%" PRId64 ",\"args\":{\"procs\":%d,\"quantum\":%" PRId64 "}}",
+        rest, t0, t1 - t0, n, quantum);
+    for (int i = 0; i < n; i++) {
+        process_track(ids[i]);
+        fprintf(f_,
+            ",\n{\"name\":\"P%d x%" PRId64 "\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%" PRId64
+            ",\"dur\":%" PRId64 ",\"args\":{\"cpu_time\":%" PRId64 "}}",
+            ids[i], rest, ids[i] + 1, t0 + i * quantum, t1 - t0 - (n - 1) * quantum,
+            rest * quantum);
+    }
+    collapsed_ += rest * n;
+}
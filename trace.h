@@ -0,0 +1,53 @@
+#pragma once
+#include "scheduler.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// SimObserver that streams the simulated schedule to a Chrome trace-event
+/// JSON file (loadable in chrome://tracing and ui.perfetto.dev)
+///
+/// one simulated time unit is written as one microsecond. Every slice goes
+/// on the "CPU 0" track and on the track of its process. Events are written
+/// through a fixed-size buffer as the engine reports them, nothing is kept
+/// in memory besides one "named" flag per process.
+///
+/// rounds skipped by the engine arrive as a single on_rounds() call and are
+/// expanded here; at most max_rounds of them are written slice by slice, the
+/// remainder of the batch is downsampled to one summary slice per track, so
+/// a run with billions of slices still produces a bounded file
+class ChromeTraceWriter : public SimObserver {
+public:
+    /// next (may be nullptr) receives all poll() calls, so the writer can
+    /// be combined with a ProgressMonitor
+    ChromeTraceWriter(const std::string & path, int64_t nprocs, int64_t max_rounds,
+        SimObserver * next = nullptr);
+    /// closes the file if close() has not been called, ignoring errors
+    ~ChromeTraceWriter();
+
+    bool poll(int64_t curr_time, int64_t finished) override;
+    void on_slice(int id, int64_t start, int64_t end) override;
+    void on_rounds(const int * ids, int n, int64_t start, int64_t quantum, int64_t rounds) override;
+
+    /// writes the closing bracket and closes the file; throws fatal_error
+    /// if writing failed (e.g. the disk is full), so a truncated trace
+    /// does not go unnoticed
+    void close();
+    /// number of slices written, and number collapsed by downsampling
+    int64_t slices_written() const { return written_; }
+    int64_t slices_collapsed() const { return collapsed_; }
+
+private:
+    FILE * f_;
+    std::string path_;
+    std::vector<char> buf_;
+    std::vector<bool> named_;
+    int64_t max_rounds_;
+    SimObserver * next_;
+    bool first_ = true;
+    int64_t written_ = 0, collapsed_ = 0;
+
+    void event(const char * name, int id, int tid, int64_t start, int64_t dur);
+    void thread_name(int tid, const char * name);
+    void process_track(int id);
+};
@@ -0,0 +1,211 @@
+#include "workload.h"
+#include "common.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool parse_process_line(
+    std::string_view line, std::vector<Process> & processes, ProcessNames * names)
+{
+    std::string_view toks[3];
+    size_t ntoks = split_into(line, toks, 3);
+    if (ntoks == 0) return false;
+    if (names && ntoks != 2 && ntoks != 3)
+        throw fatal_error() << "need 2 ints and an optional name per line";
+    if (!names && ntoks != 2) throw fatal_error() << "need 2 ints per line";
+    Process p;
+    p.id = processes.size();
+    p.arrival_time = parse_int64(toks[0]);
+    p.burst = parse_int64(toks[1]);
+    if (ntoks == 3) {
+        names->of.resize(processes.size(), -1);
+        names->of.push_back(names->words.get(toks[2]));
+    }
+    processes.push_back(p);
+    return true;
+}
+
+int64_t Distribution::sample(std::mt19937_64 & rng) const
+{
+    switch (kind) {
+    case Uniform:
+        return std::uniform_int_distribution<int64_t>(a, b)(rng);
+    case Exponential:
+        return std::llround(std::exponential_distribution<double>(1.0 / a)(rng));
+    default:
+        return a;
+    }
+}
+
+Distribution Distribution::parse(const std::string & spec)
+{
+    std::vector<std::string> toks;
+    std::string tok;
+    std::istringstream ss(spec);
+    while (std::getline(ss, tok, ':')) toks.push_back(tok);
+    Distribution d;
+    try {
+        if (toks.size() == 2 && toks[0] == "fixed") {
+            d.kind = Fixed;
+            d.a = std::stoll(toks[1]);
+        } else if (toks.size() == 3 && toks[0] == "uniform") {
+            d.kind = Uniform;
+            d.a = std::stoll(toks[1]);
+            d.b = std::stoll(toks[2]);
+        } else if (toks.size() == 2 && toks[0] == "exp") {
+            d.kind = Exponential;
+            d.a = std::stod(toks[1]);
+        } else {
+            throw fatal_error() << "unknown distribution";
+        }
+    } catch (std::exception &) {
+        throw fatal_error() << "bad distribution '" << spec
+                            << "', expected fixed:A, uniform:A:B or exp:MEAN";
+    }
+    if (d.a < 0 || (d.kind == Uniform && d.b < d.a) || (d.kind == Exponential && d.a <= 0))
+        throw fatal_error() << "bad distribution '" << spec << "'";
+    return d;
+}
+
+SyntheticSpec SyntheticSpec::parse(const std::string & spec)
+{
+    SyntheticSpec s;
+    std::string item;
+    std::istringstream ss(spec);
+    while (std::getline(ss, item, ',')) {
+        auto eq = item.find('=');
+        if (eq == std::string::npos) throw fatal_error() << "expected key=value, got '" << item << "'";
+        std::string key = item.substr(0, eq), val = item.substr(eq + 1);
+        try {
+            if (key == "n")
+                s.count = std::stoll(val);
+            else if (key == "seed")
+                s.seed = std::stoull(val);
+            else if (key == "start")
+                s.start = std::stoll(val);
+            else if (key == "gap")
+                s.gap = Distribution::parse(val);
+            else if (key == "burst")
+                s.burst = Distribution::parse(val);
+            else
+                throw fatal_error() << "unknown key '" << key << "'";
+        } catch (fatal_error &) {
+            throw;
+        } catch (std::exception &) {
+            throw fatal_error() << "bad value for " << key << ": '" << val << "'";
+        }
+    }
+    if (s.start < 0) throw fatal_error() << "start must be non-negative";
+    return s;
+}
+
+Generator<Process> synthetic_arrivals(SyntheticSpec spec)
+{
+    std::mt19937_64 rng(spec.seed);
+    Process p;
+    p.arrival_time = spec.start;
+    for (int64_t i = 0; spec.count < 0 || i < spec.count; i++) {
+        if (i > 0) p.arrival_time += std::max<int64_t>(0, spec.gap.sample(rng));
+        p.id = i;
+        p.burst = std::max<int64_t>(1, spec.burst.sample(rng));
+        co_yield p;
+    }
+}
+
+Generator<Process> replay_arrivals(std::istream & in, std::string name)
+{
+    if (!name.empty()) name += ": ";
+    std::vector<Process> one;
+    std::string line;
+    int64_t line_no = 0, last = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        one.clear();
+        try {
+            if (!parse_process_line(line, one)) continue;
+        } catch (std::exception & e) {
+            throw fatal_error() << name << "line " << line_no << ": " << e.what();
+        }
+        Process & p = one[0];
+        if (p.arrival_time < last)
+            throw fatal_error() << name << "line " << line_no << ": arrival out of order";
+        last = p.arrival_time;
+        co_yield p;
+    }
+}
+
+// loser tree: node i (1 <= i < k) holds the source that lost the match
+// played there, node 0 the overall winner; the leaves k..2k-1 are the
+// sources themselves. After yielding the winner only the matches on the
+// path from its leaf to the root are replayed, log2(k) comparisons
+Generator<Process> merge_arrivals(std::vector<Generator<Process>> sources)
+{
+    int k = sources.size();
+    if (k == 0) co_return;
+    std::vector<Process> head(k);
+    std::vector<char> live(k);
+    for (int s = 0; s < k; s++) {
+        live[s] = sources[s].next();
+        if (live[s]) head[s] = sources[s].value();
+    }
+    // whether source a goes before source b: exhausted sources lose, ties
+    // go to the lower index
+    auto before = [&](int a, int b) {
+        if (live[a] != live[b]) return bool(live[a]);
+        if (!live[a]) return a < b;
+        return head[a].arrival_time < head[b].arrival_time
+            || (head[a].arrival_time == head[b].arrival_time && a < b);
+    };
+    std::vector<int> tree(k), winner(2 * k);
+    for (int s = 0; s < k; s++) winner[k + s] = s;
+    for (int i = k - 1; i >= 1; i--) {
+        int a = winner[2 * i], b = winner[2 * i + 1];
+        winner[i] = before(a, b) ? a : b;
+        tree[i] = before(a, b) ? b : a;
+    }
+    // for k = 1 this is the only leaf
+    tree[0] = winner[1];
+
+    while (live[tree[0]]) {
+        int w = tree[0];
+        Process p = head[w];
+        p.id = w;
+        co_yield p;
+        live[w] = sources[w].next();
+        if (live[w]) head[w] = sources[w].value();
+        for (int i = (w + k) / 2; i >= 1; i /= 2) {
+            if (before(tree[i], w)) std::swap(tree[i], w);
+        }
+        tree[0] = w;
+    }
+}
+
+Generator<Process> merge_arrivals(Generator<Process> a, Generator<Process> b)
+{
+    bool has_a = a.next(), has_b = b.next();
+    while (has_a || has_b) {
+        if (has_a && (!has_b || a.value().arrival_time <= b.value().arrival_time)) {
+            co_yield a.value();
+            has_a = a.next();
+        } else {
+            co_yield b.value();
+            has_b = b.next();
+        }
+    }
+}
+
+Generator<Process> filter_arrivals(
+    Generator<Process> src, std::function<bool(const Process &)> keep)
+{
+    for (Process & p : src)
+        if (keep(p)) co_yield p;
+}
+
+Generator<Process> shift_arrivals(Generator<Process> src, int64_t delta)
+{
+    for (Process & p : src) {
+        Process q = p;
+        q.arrival_time += delta;
+        co_yield q;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "common.h"
+#include "generator.h"
+#include "scheduler.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <random>
+#include <string>
+#include <vector>
+
+/// names of the processes, for inputs with a name column: each distinct name
+/// is interned once and gets a dense number, and each process refers to the
+/// number of its name. Process ids stay the position in the input, so the
+/// same name can be given to several processes
+struct ProcessNames {
+    Word2Int words;
+    // number of the name of each process, -1 for processes without one;
+    // stops at the last named process, so unnamed inputs cost nothing
+    std::vector<int> of;
+
+    bool empty() const { return words.size() == 0; }
+    /// name of process id, empty if it has none
+    std::string_view get(int id) const
+    {
+        if (id < 0 || size_t(id) >= of.size() || of[id] < 0) return {};
+        return words.word(of[id]);
+    }
+};
+
+/// parses one line of input ("arrival burst") and appends the process to
+/// processes, with id = processes.size()
+/// if names is given, the line may have a third column with the name of the
+/// process ("arrival burst name"), which is added to names
+/// returns false for blank lines, throws fatal_error on malformed ones;
+/// allocates nothing besides growing processes and names
+bool parse_process_line(
+    std::string_view line, std::vector<Process> & processes, ProcessNames * names = nullptr);
+
+/// lazy arrival sources
+/// ------------------------------------------------------------------
+/// each source yields processes in non-decreasing arrival order, one at a
+/// time, without materialising the workload; the ids of yielded processes
+/// are not meaningful, the consumer (e.g. OnlineRR::feed()) assigns its own
+
+/// random distribution of a non-negative integer quantity
+struct Distribution {
+    enum Kind { Fixed, Uniform, Exponential };
+    Kind kind = Fixed;
+    // Fixed: a; Uniform: integers in [a, b]; Exponential: mean a
+    double a = 0, b = 0;
+
+    int64_t sample(std::mt19937_64 & rng) const;
+    /// parses "fixed:A", "uniform:A:B" or "exp:MEAN"
+    static Distribution parse(const std::string & spec);
+};
+
+/// parameters of synthetic_arrivals()
+struct SyntheticSpec {
+    // number of processes (-1 = unbounded)
+    int64_t count = 1000;
+    uint64_t seed = 1;
+    // arrival time of the first process
+    int64_t start = 0;
+    // time between consecutive arrivals
+    Distribution gap { Distribution::Exponential, 10, 0 };
+    // bursts, raised to at least 1
+    Distribution burst { Distribution::Exponential, 10, 0 };
+
+    /// parses a comma separated list of key=value settings, e.g.
+    /// "n=1000000,gap=exp:5,burst=uniform:1:50,seed=7,start=100"
+    /// throws fatal_error on unknown keys or malformed values
+    static SyntheticSpec parse(const std::string & spec);
+};
+
+/// random arrivals drawn from spec, generated one at a time
+Generator<Process> synthetic_arrivals(SyntheticSpec spec);
+/// replays "arrival burst" lines from in, which must outlive the generator
+/// throws fatal_error on malformed lines or out of order arrivals, with
+/// name (e.g. the file name) in the message if given
+Generator<Process> replay_arrivals(std::istream & in, std::string name = "");
+/// interleaves two sources by arrival time; on ties a comes first
+Generator<Process> merge_arrivals(Generator<Process> a, Generator<Process> b);
+/// interleaves any number of sources by arrival time with a loser tree, so
+/// each process costs log2(sources.size()) comparisons; on ties the lower
+/// index comes first. The id of each yielded process is the index of the
+/// source it came from
+Generator<Process> merge_arrivals(std::vector<Generator<Process>> sources);
+/// the processes of src for which keep() returns true
+Generator<Process> filter_arrivals(
+    Generator<Process> src, std::function<bool(const Process &)> keep);
+/// the processes of src arriving delta time units later
+Generator<Process> shift_arrivals(Generator<Process> src, int64_t delta);